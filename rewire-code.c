@@ -9,6 +9,17 @@
 #include <string.h>
 #include <assert.h>
 #include <time.h>
+#include <math.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#else
+#include <direct.h>
+#include <process.h>
+#endif
 
 #include "miniaig.h"
 
@@ -24,6 +35,13 @@ typedef __int64 iword;   // 32-bit windows
 typedef long long iword; // other platforms
 #endif
 
+// forced inlining (used to instantiate the simulation engine for fixed truth table sizes)
+#ifdef _MSC_VER
+#define RW_INLINE static __forceinline
+#else
+#define RW_INLINE static inline __attribute__((always_inline))
+#endif
+
 /*************************************************************
                  literal manipulation, etc
 **************************************************************/
@@ -51,40 +69,77 @@ static inline int  Lit2LitL( int * pMapV2L, int Lit )  { assert(Lit >= 0); retur
                  random number generation
 **************************************************************/
 
-// Creates a sequence of random numbers.
-// http://www.codeproject.com/KB/recipes/SimpleRNG.aspx
+// The generator is xoshiro256** (https://prng.di.unimi.it) seeded by SplitMix64.
+// Independent streams are obtained by jumping 2^128 steps ahead, so each consumer 
+// of random numbers owns a stream and the sequence it sees does not depend on 
+// how many numbers the other consumers (or threads) have drawn.
 
-#define NUMBER1  3716960521u
-#define NUMBER2  2174103536u
+typedef struct rw_rng_ {
+  word    s[4];         // the state
+} rw_rng;
 
-unsigned Random_Int( int fReset )
+static inline word Rw_HashMix( word x ) // the finalizer of SplitMix64
 {
-  static unsigned int m_z = NUMBER1;
-  static unsigned int m_w = NUMBER2;
-  if ( fReset ) {
-    m_z = NUMBER1;
-    m_w = NUMBER2;
-  }
-  m_z = 36969 * (m_z & 65535) + (m_z >> 16);
-  m_w = 18000 * (m_w & 65535) + (m_w >> 16);
-  return (m_z << 16) + m_w;
+  x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27; x *= 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
 }
-word Random_Word( int fReset )
+static inline word Rng_Rotl( word x, int k )
 {
-  return ((word)Random_Int(fReset) << 32) | ((word)Random_Int(fReset) << 0);
+  return (x << k) | (x >> (64 - k));
 }
-
-// This procedure should be called once with Seed > 0 to initialize the generator.
-// After initialization, the generator should be always called with Seed == 0.
-unsigned Random_Num( int Seed )
+static inline void Rng_Start( rw_rng * p, word Seed )
+{
+  for ( int k = 0; k < 4; k++ )
+    p->s[k] = Rw_HashMix( Seed += 0x9E3779B97F4A7C15ull );
+}
+static inline word Rng_Next( rw_rng * p )
+{
+  word * s = p->s, Res = Rng_Rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = Rng_Rotl(s[3], 45);
+  return Res;
+}
+// advances the generator by 2^128 steps
+static inline void Rng_Jump( rw_rng * p )
+{
+  static const word Jump[4] = { 0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull };
+  word s[4] = {0}; int i, b, k;
+  for ( i = 0; i < 4; i++ )
+    for ( b = 0; b < 64; b++ ) {
+      if ( (Jump[i] >> b) & 1 )
+        for ( k = 0; k < 4; k++ )
+          s[k] ^= p->s[k];
+      Rng_Next( p );
+    }
+  memcpy( p->s, s, sizeof(s) );
+}
+// splits off a new stream (the current one moves 2^128 steps ahead)
+static inline void Rng_Split( rw_rng * p, rw_rng * pNew )
+{
+  *pNew = *p;
+  Rng_Jump( p );
+}
+// returns a uniformly distributed number in [0, n) using Lemire's multiply-shift method;
+// the division computing the rejection threshold is needed with probability n/2^32
+static inline unsigned Rng_Bound( rw_rng * p, unsigned n )
 {
-  static unsigned RandMask = 0;
-  if ( Seed == 0 )
-    return RandMask ^ Random_Int(0);
-  RandMask = Random_Int(1);
-  for ( int i = 0; i < Seed; i++ )
-    RandMask = Random_Int(0);
-  return RandMask;
+  word m = (Rng_Next(p) >> 32) * (word)n;
+  if ( (unsigned)m < n ) {
+    unsigned t = (0u - n) % n;
+    while ( (unsigned)m < t )
+      m = (Rng_Next(p) >> 32) * (word)n;
+  }
+  return (unsigned)(m >> 32);
+}
+// returns a uniformly distributed number in [0, 1)
+static inline double Rng_Real( rw_rng * p )
+{
+  return (Rng_Next(p) >> 11) * (1.0 / 9007199254740992.0);
 }
 
 /*************************************************************
@@ -114,6 +169,116 @@ static inline void Time_Print( const char * pStr, iword time )
   printf( "%s = %9.2f sec", pStr, (float)1.0*((double)(time))/((double)CLOCKS_PER_SEC) );
 }
 
+/*************************************************************
+                       thread pool
+**************************************************************/
+
+// The workers sleep until a job is posted; the job is then run by every thread 
+// (including the caller) with its own index, and the caller returns when all 
+// threads are done. Without pthreads (on Windows), the jobs run in the caller.
+
+typedef void (* rw_job)( void * pArg, int iThread, int nThreads );
+
+typedef struct rw_pool_ {
+  int             nThreads;   // the number of threads including the caller
+  rw_job          pJob;       // the current job
+  void *          pArg;       // the argument of the current job
+#ifndef _WIN32
+  pthread_t *     pWorkers;   // the worker threads
+  pthread_mutex_t Mutex;      // protects the fields below
+  pthread_cond_t  CondJob;    // signals a new job or stopping
+  pthread_cond_t  CondDone;   // signals that the workers are done with the job
+  int             nStarted;   // the number of started workers (used to assign the indexes)
+  int             iJob;       // the job counter
+  int             nDone;      // the number of workers done with the current job
+  int             fStop;      // the workers should exit
+#endif
+} rw_pool;
+
+#ifndef _WIN32
+static void * Rw_PoolWorker( void * pArg )
+{
+  rw_pool * p = (rw_pool *)pArg; int iThread, iJob = 0;
+  pthread_mutex_lock( &p->Mutex );
+  iThread = ++p->nStarted;
+  while ( 1 ) {
+    while ( p->iJob == iJob && !p->fStop )
+      pthread_cond_wait( &p->CondJob, &p->Mutex );
+    if ( p->fStop )
+      break;
+    iJob = p->iJob;
+    pthread_mutex_unlock( &p->Mutex );
+    p->pJob( p->pArg, iThread, p->nThreads );
+    pthread_mutex_lock( &p->Mutex );
+    if ( ++p->nDone == p->nThreads - 1 )
+      pthread_cond_signal( &p->CondDone );
+  }
+  pthread_mutex_unlock( &p->Mutex );
+  return NULL;
+}
+#endif
+static inline rw_pool * Rw_PoolStart( int nThreads )
+{
+  rw_pool * p = (rw_pool *)calloc( sizeof(rw_pool), 1 );
+#ifndef _WIN32
+  int i;
+  p->nThreads = nThreads;
+  p->pWorkers = (pthread_t *)calloc( sizeof(pthread_t), nThreads );
+  pthread_mutex_init( &p->Mutex, NULL );
+  pthread_cond_init( &p->CondJob, NULL );
+  pthread_cond_init( &p->CondDone, NULL );
+  for ( i = 1; i < nThreads; i++ )
+    if ( pthread_create( p->pWorkers + i, NULL, Rw_PoolWorker, p ) ) {
+      printf( "Cannot create thread %d; continuing with %d threads.\n", i, i );
+      pthread_mutex_lock( &p->Mutex );
+      p->nThreads = i;
+      pthread_mutex_unlock( &p->Mutex );
+      break;
+    }
+#else
+  p->nThreads = 1;
+#endif
+  return p;
+}
+static inline void Rw_PoolStop( rw_pool * p )
+{
+#ifndef _WIN32
+  int i;
+  pthread_mutex_lock( &p->Mutex );
+  p->fStop = 1;
+  pthread_cond_broadcast( &p->CondJob );
+  pthread_mutex_unlock( &p->Mutex );
+  for ( i = 1; i < p->nThreads; i++ )
+    pthread_join( p->pWorkers[i], NULL );
+  pthread_mutex_destroy( &p->Mutex );
+  pthread_cond_destroy( &p->CondJob );
+  pthread_cond_destroy( &p->CondDone );
+  free( p->pWorkers );
+#endif
+  free( p );
+}
+static inline void Rw_PoolRun( rw_pool * p, rw_job pJob, void * pArg )
+{
+  if ( p->nThreads == 1 ) {
+    pJob( pArg, 0, 1 );
+    return;
+  }
+#ifndef _WIN32
+  pthread_mutex_lock( &p->Mutex );
+  p->pJob  = pJob;
+  p->pArg  = pArg;
+  p->nDone = 0;
+  p->iJob++;
+  pthread_cond_broadcast( &p->CondJob );
+  pthread_mutex_unlock( &p->Mutex );
+  pJob( pArg, 0, p->nThreads );
+  pthread_mutex_lock( &p->Mutex );
+  while ( p->nDone < p->nThreads - 1 )
+    pthread_cond_wait( &p->CondDone, &p->Mutex );
+  pthread_mutex_unlock( &p->Mutex );
+#endif
+}
+
 /*************************************************************
                  vector of 32-bit integers
 **************************************************************/
@@ -185,9 +350,9 @@ static inline int  Vi_Remove(vi* v, int e) {
   Vi_Drop( v, j );
   return 1;
 }
-static inline void Vi_Randomize(vi * v) {
-  for ( int i = 0; i < v->size; i++ ) {
-    int iRand = Random_Num(0) % v->size;
+static inline void Vi_Randomize(vi * v, rw_rng * pRng) { // Fisher-Yates shuffle
+  for ( int i = v->size - 1; i > 0; i-- ) {
+    int iRand = Rng_Bound( pRng, i + 1 );
     RW_SWAP( int, v->ptr[iRand], v->ptr[i] );
   }
 }
@@ -298,6 +463,12 @@ static inline void Tt_Dup( word * pOut, word * pIn, int nWords ) {
   for ( w = 0; w < nWords; w++ )
     pOut[w] = pIn[w];
 }
+// copies the first nPeriod words over the rest of the table (both sizes are powers of 2)
+static inline void Tt_Replicate( word * pOut, int nPeriod, int nWords ) {
+  int w;
+  for ( w = nPeriod; w < nWords; w *= 2 )
+    memcpy( pOut + w, pOut, sizeof(word) * w );
+}
 static inline void Tt_DupC( word * pOut, word * pIn, int fC, int nWords ) {
   int w;
   if ( fC )
@@ -326,11 +497,26 @@ static inline void Tt_Sharp( word * pOut, word * pIn, int fC, int nWords ) {
     for ( w = 0; w < nWords; w++ )
       pOut[w] &= pIn[w];
 }
+static inline void Tt_XorC( word * pOut, word * pIn1, word * pIn2, int fC, int nWords ) {
+  word Mask = fC ? ~(word)0 : 0; int w;
+  for ( w = 0; w < nWords; w++ )
+    pOut[w] = pIn1[w] ^ pIn2[w] ^ Mask;
+}
+static inline void Tt_MuxC( word * pOut, word * pCtrl, word * pIn1, int fC1, word * pIn0, int fC0, int nWords ) {
+  word Mask1 = fC1 ? ~(word)0 : 0, Mask0 = fC0 ? ~(word)0 : 0; int w;
+  for ( w = 0; w < nWords; w++ )
+    pOut[w] = (pCtrl[w] & (pIn1[w] ^ Mask1)) | (~pCtrl[w] & (pIn0[w] ^ Mask0));
+}
 static inline void Tt_OrXor( word * pOut, word * pIn1, word * pIn2, int nWords ) {
   int w;
   for ( w = 0; w < nWords; w++ )
     pOut[w] |= pIn1[w] ^ pIn2[w];
 }
+static inline void Tt_OrXorAnd( word * pOut, word * pIn1, word * pIn2, word * pIn3, int nWords ) {
+  int w;
+  for ( w = 0; w < nWords; w++ )
+    pOut[w] |= (pIn1[w] ^ pIn2[w]) & pIn3[w];
+}
 static inline int Tt_WordNum( int n ) {
   return n > 6 ? (1 << (n-6)) : 1;
 }
@@ -357,6 +543,20 @@ static inline int Tt_IntersectC( word * pIn1, word * pIn2, int fC, int nWords )
   }
   return 0;
 }
+static inline int Tt_IntersectC2( word * pCare, word * pIn1, int fC1, word * pIn2, int fC2, int nWords ) {
+  word m1 = fC1 ? ~(word)0 : 0, m2 = fC2 ? ~(word)0 : 0; int w;
+  for ( w = 0; w < nWords; w++ )
+    if ( pCare[w] & (pIn1[w] ^ m1) & (pIn2[w] ^ m2) )
+      return 1;
+  return 0;
+}
+static inline int Tt_IntersectC3( word * pCare, word * pIn1, int fC1, word * pIn2, int fC2, word * pIn3, int fC3, int nWords ) {
+  word m1 = fC1 ? ~(word)0 : 0, m2 = fC2 ? ~(word)0 : 0, m3 = fC3 ? ~(word)0 : 0; int w;
+  for ( w = 0; w < nWords; w++ )
+    if ( pCare[w] & (pIn1[w] ^ m1) & (pIn2[w] ^ m2) & (pIn3[w] ^ m3) )
+      return 1;
+  return 0;
+}
 static inline int Tt_Equal( word * pIn1, word * pIn2, int nWords ) {
   int w;
   for ( w = 0; w < nWords; w++ )
@@ -391,6 +591,7 @@ static inline void    Tt_XorBit( word * p, int k )             { p[k>>6] ^= (((w
 typedef struct maig_ {
   int     nIns;         // primary inputs
   int     nOuts;        // primary outputs
+  int     nRegs;        // registers (the last nRegs inputs/outputs are the register outputs/inputs)
   int     nObjs;        // all objects
   int     nObjsAlloc;   // allocated space
   int     nWords;       // the truth table size
@@ -401,13 +602,35 @@ typedef struct maig_ {
   word *  pTruths[3];   // truth tables
   word *  pCare;        // careset
   word *  pProd;        // product
+  int     fBlocked;     // simulate truth tables block by block
+  int     nMemLimit;    // the memory limit for truth tables in MB (0 = no limit)
+  int     nSlots;       // the number of cached truth tables (0 = tables of all objects are stored)
+  int     nSlotsBase;   // the number of slots within the memory limit (the others are added when all are locked)
+  int     iSlotHand;    // the clock hand used to select the slot to evict
+  int     iCareObj;     // the node whose care set is being computed
+  int *   pSlots;       // the slot of each table (two tables per object)
+  int *   pSlotKeys;    // the table stored in each slot
+  int *   pSlotPins;    // the number of locks of each slot
+  int *   pSlotRefs;    // the reference bit of each slot
+  int *   pSlotGens;    // the traversal ID when each slot was written
+  word ** pSlotData;    // the table of each slot
+  word *  pSigns;       // simulation signatures used to filter resubstitution divisors
+  int *   pPeriods;     // the number of words after which the truth table repeats (set by the last input in the fanin cone)
+  word *  pCareOuts;    // external care sets of the outputs (not owned; NULL = completely specified)
+  vi *    vSupers;      // cached supergates and their last decomposition (used by Maig_DupMulti)
+  rw_rng * pRng;        // the random number stream of the current stage (not owned)
+  rw_pool * pPool;      // the threads simulating large truth tables (not owned; NULL = one thread)
+  int     fSupersDfs;   // the root order of the cached supergates
   vi *    vOrder;       // node order
   vi *    vOrderF;      // fanin order
   vi *    vOrderF2;     // fanin order
   vi *    vTfo;         // transitive fanout cone
+  vi *    vFound;       // the fanins found by the expansion
   vi *    pvFans;       // the array of objects' fanins
+  char *  pKinds;       // the kinds of the nodes (NULL = all nodes are ANDs)
   int *   pTable;       // structural hashing table
   int     TableSize;    // the size of the hash table
+  vi *    vJournal;     // the change journal (NULL = the edits are not recorded)
 } maig;
 
 #define Maig_ForEachConstInput( p, i )           for (i = 0; i <= p->nIns; i++)
@@ -426,6 +649,16 @@ static inline int Maig_ObjIsPi( maig * p, int i )   { return i > 0 && i <= p->nI
 static inline int Maig_ObjIsPo( maig * p, int i )   { return i >= p->nObjs - p->nOuts;               }
 static inline int Maig_ObjIsNode( maig * p, int i ) { return i > p->nIns && i < p->nObjs - p->nOuts; }
 
+// a node is a multi-input AND unless its kind says otherwise: a XOR node has two fanins (a, b) 
+// and a MUX node has three fanins (c, t, e) computing c ? t : e, which are kept in this order
+#define MAIG_AND  0
+#define MAIG_XOR  1
+#define MAIG_MUX  2
+
+static inline int Maig_ObjKind( maig * p, int i )   { return p->pKinds ? p->pKinds[i] : MAIG_AND;    }
+static inline int Maig_ObjIsAnd( maig * p, int i )  { return Maig_ObjKind(p, i) == MAIG_AND;         }
+static inline int Maig_ObjIsMux( maig * p, int i )  { return Maig_ObjKind(p, i) == MAIG_MUX;         }
+
 static inline maig * Maig_Alloc( int nIns, int nOuts, int nObjsAlloc )
 {
   assert( 1 + nIns + nOuts <= nObjsAlloc );
@@ -443,6 +676,7 @@ static inline maig * Maig_Alloc( int nIns, int nOuts, int nObjsAlloc )
   p->vOrderF    = Vi_Alloc( 1000 );  
   p->vOrderF2   = Vi_Alloc( 1000 );  
   p->vTfo       = Vi_Alloc( 1000 );  
+  p->vFound     = Vi_Alloc( 100 );  
   p->pvFans     = (vi *)calloc( sizeof(vi), p->nObjsAlloc );
   return p;
 }
@@ -457,6 +691,7 @@ static inline void Maig_Free( maig * p )
   Vi_Free(p->vOrderF);
   Vi_Free(p->vOrderF2);
   Vi_Free(p->vTfo);
+  Vi_Free(p->vFound);
   free(p->pTravIds);
   free(p->pCopy);
   free(p->pRefs);
@@ -465,7 +700,22 @@ static inline void Maig_Free( maig * p )
       free(p->pTruths[i]);
   if ( p->pCare )  free(p->pCare);
   if ( p->pProd )  free(p->pProd);    
+  if ( p->pSlots ) {
+    free(p->pSlots);
+    free(p->pSlotKeys);
+    free(p->pSlotPins);
+    free(p->pSlotRefs);
+    free(p->pSlotGens);
+    for ( i = p->nSlotsBase; i < p->nSlots; i++ )
+      free(p->pSlotData[i]);
+    free(p->pSlotData);
+  }
+  if ( p->pSigns ) free(p->pSigns);
+  if ( p->pPeriods ) free(p->pPeriods);
+  if ( p->vSupers ) Vi_Free(p->vSupers);
   if ( p->pTable ) free(p->pTable);
+  if ( p->vJournal ) Vi_Free(p->vJournal);
+  if ( p->pKinds ) free(p->pKinds);
   free(p);
 }
 static inline void Maig_Print( maig * p )
@@ -476,7 +726,7 @@ static inline void Maig_Print( maig * p )
   Maig_ForEachInput( p, i )
     printf( "Pi%d\n", i );
   Maig_ForEachNode( p, i ) {
-    printf( "Node%d {", i );
+    printf( "%s%d {", Maig_ObjIsAnd(p, i) ? "Node" : Maig_ObjIsMux(p, i) ? "Mux" : "Xor", i );
     Maig_ForEachObjFanin( p, i, iLit, k )
       printf( " %d", iLit );
     printf( " }\n" );
@@ -492,11 +742,27 @@ static inline void Maig_Print( maig * p )
 static inline int Maig_AppendObj(maig *p) 
 { 
     assert(p->nObjs < p->nObjsAlloc);
+    if ( p->vJournal ) {
+      Vi_Push(p->vJournal, -1);
+      Vi_Push(p->vJournal, p->nObjs);
+    }
     return p->nObjs++;
 }
 static inline void Maig_AppendFanin(maig *p, int i, int iLit) 
 { 
-    Vi_PushOrder(p->pvFans+i, iLit);
+    if ( Maig_ObjIsMux(p, i) )
+      Vi_Push(p->pvFans+i, iLit);
+    else
+      Vi_PushOrder(p->pvFans+i, iLit);
+}
+// the kind should be set before the fanins are appended
+static inline void Maig_ObjSetKind( maig * p, int i, int Kind )
+{
+  if ( p->pKinds == NULL && Kind == MAIG_AND )
+    return;
+  if ( p->pKinds == NULL )
+    p->pKinds = (char *)calloc( sizeof(char), p->nObjsAlloc );
+  p->pKinds[i] = (char)Kind;
 }
 static inline int Maig_ObjFaninNum( maig * p, int i )
 {
@@ -511,15 +777,42 @@ static inline int Maig_ObjFanin1( maig * p, int i )
   assert( Maig_ObjFaninNum(p, i) == 2 );
   return Vi_Read(p->pvFans+i, 1);
 }
+// returns the fanins (c, t, e) of the XOR/MUX node, where XOR(a, b) = MUX(a, ~b, b)
+static inline void Maig_ObjMuxFanins( maig * p, int i, int * pLits )
+{
+  int * pFans = Vi_Array(p->pvFans+i);
+  assert( !Maig_ObjIsAnd(p, i) );
+  pLits[0] = pFans[0];
+  pLits[1] = Maig_ObjIsMux(p, i) ? pFans[1] : LitNot(pFans[1]);
+  pLits[2] = pFans[Maig_ObjFaninNum(p, i)-1];
+}
 
+// the number of AND2 gates of the node (a XOR/MUX node is decomposed into three)
+static inline int Maig_ObjAnd2Num( maig * p, int i )
+{
+  return Maig_ObjIsAnd(p, i) ? Maig_ObjFaninNum(p, i) - 1 : 3;
+}
 static inline int Maig_CountAnd2( maig * g )
 {
   int i, Counter = 0;
   Maig_ForEachNode( g, i )
-      Counter += Maig_ObjFaninNum(g, i) - 1;
+      Counter += Maig_ObjAnd2Num(g, i);
   return Counter;
 }
 
+static inline int Maig_LevelNum( maig * p )
+{
+  int i, k, iLit, LevelMax = 0;
+  int * pLevels = (int *)calloc( sizeof(int), p->nObjs );
+  Maig_ForEachNodeOutput( p, i ) {
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      pLevels[i] = MaxInt( pLevels[i], pLevels[Lit2Var(iLit)] );
+    LevelMax = MaxInt( LevelMax, ++pLevels[i] );
+  }
+  free( pLevels );
+  return LevelMax;
+}
+
 // reference counting
 static inline void Maig_ObjRef( maig * p, int iObj )
 {
@@ -539,16 +832,76 @@ static inline void Maig_ObjDeref_rec( maig * p, int iObj, int iLitSkip )
   Maig_ForEachObjFanin( p, iObj, iLit, k ) 
     if ( iLit != iLitSkip && --p->pRefs[Lit2Var(iLit)] == 0 && Maig_ObjIsNode(p, Lit2Var(iLit)) ) {
       Maig_ObjDeref_rec(p, Lit2Var(iLit), -1);
+      Maig_ObjSetKind(p, Lit2Var(iLit), MAIG_AND);
       Vi_Fill(p->pvFans+Lit2Var(iLit), 1, 0);
       Maig_ObjRef(p, Lit2Var(iLit));
     }
 }
+// these two procedures count the AND2 gates in the MFFC of the node without changing it
+static inline int Maig_ObjDerefCount_rec( maig * p, int iObj )
+{
+  int k, iLit, Count = Maig_ObjAnd2Num(p, iObj);
+  Maig_ForEachObjFanin( p, iObj, iLit, k ) 
+    if ( --p->pRefs[Lit2Var(iLit)] == 0 && Maig_ObjIsNode(p, Lit2Var(iLit)) )
+      Count += Maig_ObjDerefCount_rec( p, Lit2Var(iLit) );
+  return Count;
+}
+static inline void Maig_ObjRef_rec( maig * p, int iObj )
+{
+  int k, iLit;
+  Maig_ForEachObjFanin( p, iObj, iLit, k ) 
+    if ( p->pRefs[Lit2Var(iLit)]++ == 0 && Maig_ObjIsNode(p, Lit2Var(iLit)) )
+      Maig_ObjRef_rec( p, Lit2Var(iLit) );
+}
 static inline void Maig_InitializeRefs( maig * p )
 {
   int i; memset( p->pRefs, 0, sizeof(int)*p->nObjs );
   Maig_ForEachNodeOutput( p, i )
     Maig_ObjRef( p, i );
 }
+
+// The change journal records the fanins of an object before they are edited (Maig_JournalSave)
+// and the appended objects (Maig_AppendObj), so that the edits can be undone in the reverse order 
+// in time proportional to their number. Each record is the saved fanins followed by their number
+// (-1 for an appended object) and the object. The reference counters are not restored because 
+// the stages recompute them (Maig_InitializeRefs).
+static inline void Maig_JournalStart( maig * p )
+{
+  assert( p->vJournal == NULL );
+  p->vJournal = Vi_Alloc( 1000 );
+}
+static inline void Maig_JournalStop( maig * p ) // keeps the edits
+{
+  Vi_Free( p->vJournal );
+  p->vJournal = NULL;
+}
+static inline void Maig_JournalSave( maig * p, int iObj )
+{
+  if ( p->vJournal == NULL )
+    return;
+  Vi_PushArray( p->vJournal, Vi_Array(p->pvFans+iObj), Vi_Size(p->pvFans+iObj) );
+  Vi_Push( p->vJournal, Vi_Size(p->pvFans+iObj) );
+  Vi_Push( p->vJournal, iObj );
+}
+static inline void Maig_JournalUndo( maig * p ) // restores the network as it was when the journal was started
+{
+  vi * vJour = p->vJournal;
+  while ( Vi_Size(vJour) > 0 ) {
+    int iObj = Vi_Pop(vJour), nFans = Vi_Pop(vJour);
+    vi * vFans = p->pvFans + iObj;
+    if ( nFans == -1 ) {
+      assert( iObj == p->nObjs - 1 );
+      if ( vFans->ptr ) free( vFans->ptr );
+      memset( vFans, 0, sizeof(vi) );
+      p->nObjs--;
+      continue;
+    }
+    Vi_Shrink( vJour, Vi_Size(vJour) - nFans );
+    Vi_Shrink( vFans, 0 );
+    Vi_PushArray( vFans, Vi_Array(vJour) + Vi_Size(vJour), nFans );
+  }
+  Maig_JournalStop( p );
+}
 static inline void Maig_VerifyRefs( maig * p )
 {
   int i; 
@@ -569,6 +922,7 @@ static inline maig * Maig_FromMiniAig( Mini_Aig_t * p )
 {
   int * pCopy = (int *)calloc( sizeof(int), Mini_AigNodeNum(p) ); // obj2obj
   maig * pNew = Maig_Alloc( Mini_AigPiNum(p), Mini_AigPoNum(p), Mini_AigNodeNum(p) ); int i;
+  pNew->nRegs = Mini_AigRegNum(p); // the registers are the last combinational inputs/outputs in both
   Maig_ForEachInput( pNew, i )
     pCopy[i] = i;  
   Mini_AigForEachAnd( p, i ) {
@@ -591,6 +945,16 @@ static inline Mini_Aig_t * Maig_ToMiniAig( maig * p )
     p->pCopy[i] = Mini_AigCreatePi(pMini);
   Maig_ForEachNode( p, i ) {
     assert( Maig_ObjFaninNum(p, i) > 0 );
+    if ( !Maig_ObjIsAnd(p, i) ) { // MUX(c, t, e) = ~(~(c & t) & ~(~c & e))
+      int pLits[3];
+      Maig_ObjMuxFanins( p, i, pLits );
+      for ( k = 0; k < 3; k++ )
+        pLits[k] = Lit2LitL(p->pCopy, pLits[k]);
+      iLit  = Mini_AigAnd( pMini, pLits[0], pLits[1] );
+      iLit2 = Mini_AigAnd( pMini, LitNot(pLits[0]), pLits[2] );
+      p->pCopy[i] = LitNot( Mini_AigAnd(pMini, LitNot(iLit), LitNot(iLit2)) );
+      continue;
+    }
     Maig_ForEachObjFanin( p, i, iLit, k )
       if ( k == 0 )
         p->pCopy[i] = Lit2LitL(p->pCopy, iLit);
@@ -604,14 +968,221 @@ static inline Mini_Aig_t * Maig_ToMiniAig( maig * p )
       Mini_AigCreatePo( pMini, Lit2LitL(p->pCopy, iLit) );
   }
   assert( pMini->nSize == 2 * (1 + p->nIns + p->nOuts + And2) );
+  Mini_AigSetRegNum( pMini, p->nRegs );
   return pMini;    
 }
 
+/*************************************************************
+                 AIGER file <--> Maig 
+**************************************************************/
+
+// maps the file into memory (reads it on platforms without mmap)
+static inline unsigned char * Maig_FileMap( char * pFileName, size_t * pnSize )
+{
+  unsigned char * pData = NULL;
+#ifdef _WIN32
+  FILE * pFile = fopen( pFileName, "rb" );
+  if ( pFile == NULL )
+    return NULL;
+  fseek( pFile, 0, SEEK_END );
+  *pnSize = (size_t)ftell( pFile );
+  fseek( pFile, 0, SEEK_SET );
+  pData = (unsigned char *)malloc( *pnSize + 1 );
+  if ( fread(pData, 1, *pnSize, pFile) != *pnSize )
+    free( pData ), pData = NULL;
+  fclose( pFile );
+#else
+  struct stat Stat;
+  int fd = open( pFileName, O_RDONLY );
+  if ( fd < 0 )
+    return NULL;
+  if ( fstat(fd, &Stat) == 0 && Stat.st_size > 0 ) {
+    *pnSize = (size_t)Stat.st_size;
+    pData = (unsigned char *)mmap( NULL, *pnSize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( pData == (unsigned char *)MAP_FAILED )
+      pData = NULL;
+  }
+  close( fd );
+#endif
+  return pData;
+}
+static inline void Maig_FileUnmap( unsigned char * pData, size_t nSize )
+{
+#ifdef _WIN32
+  free( pData );
+#else
+  munmap( pData, nSize );
+#endif
+}
+// these two procedures return -1 when the data ends prematurely
+static inline int Maig_AigerReadUnsigned( unsigned char ** ppCur, unsigned char * pEnd )
+{
+  unsigned x = 0, i = 0; unsigned char ch;
+  do {
+    if ( *ppCur == pEnd || i == 5 )
+      return -1;
+    ch = *(*ppCur)++;
+    x |= (unsigned)(ch & 0x7f) << (7 * i++);
+  } while ( ch & 0x80 );
+  return x > 0x7FFFFFFF ? -1 : (int)x;
+}
+static inline int Maig_AigerReadDecimal( unsigned char ** ppCur, unsigned char * pEnd )
+{
+  int x = 0, nDigits = 0;
+  while ( *ppCur < pEnd && **ppCur == ' ' )
+    (*ppCur)++;
+  for ( ; *ppCur < pEnd && **ppCur >= '0' && **ppCur <= '9'; (*ppCur)++, nDigits++ ) {
+    if ( x > (0x7FFFFFFF - (**ppCur - '0')) / 10 )
+      return -1;
+    x = 10 * x + (**ppCur - '0');
+  }
+  return nDigits ? x : -1;
+}
+static inline void Maig_AigerSkipLine( unsigned char ** ppCur, unsigned char * pEnd )
+{
+  while ( *ppCur < pEnd && *(*ppCur)++ != '\n' );
+}
+// reads the binary AIGER file directly into the multi-input AIG 
+// (the latch outputs become the last inputs and the latch inputs become the last outputs)
+static inline maig * Maig_AigerRead( char * pFileName, int * pnRegs, int fVerbose )
+{
+  size_t nSize = 0; maig * p = NULL;
+  unsigned char * pData = Maig_FileMap( pFileName, &nSize ), * pCur = pData, * pEnd = pData + nSize;
+  int i, nObjs, nIns, nLatches, nOuts, nAnds, iLit, iLit0, iLit1, fError = 0, fInits = 0;
+  if ( pData == NULL ) {
+    printf( "Cannot open the input file \"%s\".\n", pFileName );
+    return NULL;
+  }
+  if ( nSize < 3 || pCur[0] != 'a' || pCur[1] != 'i' || pCur[2] != 'g' ) {
+    printf( "The file \"%s\" is not a binary AIGER file.\n", pFileName );
+    Maig_FileUnmap( pData, nSize );
+    return NULL;
+  }
+  pCur += 3;
+  nObjs    = Maig_AigerReadDecimal( &pCur, pEnd );
+  nIns     = Maig_AigerReadDecimal( &pCur, pEnd );
+  nLatches = Maig_AigerReadDecimal( &pCur, pEnd );
+  nOuts    = Maig_AigerReadDecimal( &pCur, pEnd );
+  nAnds    = Maig_AigerReadDecimal( &pCur, pEnd );
+  Maig_AigerSkipLine( &pCur, pEnd );
+  // the literals of all objects should fit into int, and each output, latch and AND takes at least two bytes
+  if ( nAnds < 0 || nOuts < 0 || nLatches < 0 || nIns < 0 || nObjs != (iword)nIns + nLatches + nAnds ||
+       2 * ((iword)1 + nObjs + nOuts + nLatches) + 1 > 0x7FFFFFFF || 2 * ((iword)nOuts + nLatches + nAnds) > pEnd - pCur ) {
+    printf( "The header of the AIGER file \"%s\" is incorrect.\n", pFileName );
+    Maig_FileUnmap( pData, nSize );
+    return NULL;
+  }
+  // all objects are created at once with fanin arrays of the exact size
+  p = Maig_Alloc( nIns + nLatches, nOuts + nLatches, 1 + nObjs + nOuts + nLatches );
+  p->nObjs = p->nObjsAlloc;
+  p->nRegs = nLatches;
+  for ( i = 0; i < nLatches + nOuts && !fError; i++ ) {
+    int iObj = 1 + nObjs + (i < nLatches ? nOuts + i : i - nLatches);
+    iLit = Maig_AigerReadDecimal( &pCur, pEnd );
+    if ( i < nLatches && pCur < pEnd && *pCur == ' ' ) // the optional initial value (only 0 is supported)
+      fInits |= Maig_AigerReadDecimal( &pCur, pEnd ) > 0;
+    Maig_AigerSkipLine( &pCur, pEnd );
+    if ( (fError = (iLit < 0 || iLit > 2*nObjs+1)) )
+      break;
+    Vi_Start( p->pvFans+iObj, 1 );
+    Vi_Push( p->pvFans+iObj, iLit );
+  }
+  for ( i = 1 + nIns + nLatches; i <= nObjs && !fError; i++ ) {
+    int Delta0 = Maig_AigerReadUnsigned( &pCur, pEnd );
+    int Delta1 = Maig_AigerReadUnsigned( &pCur, pEnd );
+    if ( (fError = (Delta0 <= 0 || Delta1 < 0 || Delta0 + Delta1 > 2*i)) )
+      break;
+    iLit1 = 2*i - Delta0;
+    iLit0 = iLit1 - Delta1;
+    Vi_Start( p->pvFans+i, 2 );
+    Vi_PushTwo( p->pvFans+i, iLit0, iLit1 );
+  }
+  Maig_FileUnmap( pData, nSize );
+  if ( fError ) {
+    printf( "The AIGER file \"%s\" is corrupted.\n", pFileName );
+    Maig_Free( p );
+    return NULL;
+  }
+  if ( fInits ) {
+    printf( "The AIGER file \"%s\" has registers with non-zero initial values, which are not supported.\n", pFileName );
+    Maig_Free( p );
+    return NULL;
+  }
+  if ( pnRegs ) 
+    *pnRegs = nLatches;
+  if ( fVerbose ) 
+    printf( "Loaded AIG from the AIGER file \"%s\".\n", pFileName );
+  return p;
+}
+// the AND gates are encoded into a buffer written to the file in large chunks
+#define RW_WRITE_BUFFER (1 << 16)
+static inline void Maig_AigerWriteUnsigned( FILE * pFile, unsigned char * pBuffer, int * pnBuffer, unsigned x )
+{
+  if ( *pnBuffer > RW_WRITE_BUFFER - 8 ) {
+    fwrite( pBuffer, 1, *pnBuffer, pFile );
+    *pnBuffer = 0;
+  }
+  while ( x & ~0x7f ) {
+    pBuffer[(*pnBuffer)++] = (unsigned char)((x & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  pBuffer[(*pnBuffer)++] = (unsigned char)x;
+}
+// writes the binary AIGER file directly from the multi-input AIG (nodes become chains of two-input ANDs;
+// the last nRegs inputs/outputs become the outputs/inputs of the registers, which are initialized to 0)
+// returns 1 if the file was written
+static inline int Maig_AigerWrite( char * pFileName, maig * p, int fVerbose )
+{
+  int i, k, iLit, iPrev = 0, iNext, nAnds = Maig_CountAnd2(p), iVar = p->nIns, nBuffer = 0;
+  unsigned char pBuffer[RW_WRITE_BUFFER];
+  FILE * pFile = fopen( pFileName, "wb" );
+  if ( pFile == NULL ) {
+    printf( "Cannot open the output file \"%s\".\n", pFileName );
+    return 0;
+  }
+  // the first pass assigns the literals because the outputs are written before the AND gates
+  Maig_ForEachConstInput( p, i )
+    p->pCopy[i] = Var2Lit( i, 0 );
+  Maig_ForEachNode( p, i ) {
+    assert( Maig_ObjFaninNum(p, i) > 0 );
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      p->pCopy[i] = k ? Var2Lit(++iVar, 0) : Lit2LitL(p->pCopy, iLit);
+  }
+  assert( iVar == p->nIns + nAnds );
+  fprintf( pFile, "aig %d %d %d %d %d\n", p->nIns + nAnds, p->nIns - p->nRegs, p->nRegs, p->nOuts - p->nRegs, nAnds );
+  for ( i = p->nObjs - p->nRegs; i < p->nObjs; i++ )
+    fprintf( pFile, "%d\n", Lit2LitL(p->pCopy, Maig_ObjFanin0(p, i)) );
+  for ( i = p->nObjs - p->nOuts; i < p->nObjs - p->nRegs; i++ )
+    fprintf( pFile, "%d\n", Lit2LitL(p->pCopy, Maig_ObjFanin0(p, i)) );
+  iVar = p->nIns;
+  Maig_ForEachNode( p, i )
+    Maig_ForEachObjFanin( p, i, iLit, k ) {
+      iNext = Lit2LitL(p->pCopy, iLit);
+      if ( k ) {
+        Maig_AigerWriteUnsigned( pFile, pBuffer, &nBuffer, Var2Lit(++iVar, 0) - MaxInt(iPrev, iNext) );
+        Maig_AigerWriteUnsigned( pFile, pBuffer, &nBuffer, MaxInt(iPrev, iNext) - MinInt(iPrev, iNext) );
+        iNext = Var2Lit(iVar, 0);
+      }
+      iPrev = iNext;
+    }
+  fwrite( pBuffer, 1, nBuffer, pFile );
+  fprintf( pFile, "c\n" );
+  if ( fclose( pFile ) ) {
+    printf( "Cannot write the output file \"%s\".\n", pFileName );
+    return 0;
+  }
+  if ( fVerbose ) 
+    printf( "Written AIG into the AIGER file \"%s\".\n", pFileName );
+  return 1;
+}
+static inline void Maig_PrintStats( maig * p )
+{
+  printf( "AIG stats:  PI = %d  PO = %d  FF = %d  AND = %d\n", p->nIns - p->nRegs, p->nOuts - p->nRegs, p->nRegs, Maig_CountAnd2(p) );
+}
+
 void Rw_DumpAiger( maig * g, char * pFileName )
 {
-  Mini_Aig_t * p = Maig_ToMiniAig( g );
-  Mini_AigerWrite( pFileName, p, 1 );
-  Mini_AigStop( p );
+  Maig_AigerWrite( pFileName, g, 1 );
 }
 
 /*************************************************************
@@ -647,6 +1218,7 @@ static inline int Maig_MarkDfs( maig * p )
 static inline maig * Maig_Dup( maig * p, int fRemDangle )
 {
   maig * pNew = Maig_Alloc( p->nIns, p->nOuts, p->nObjs );
+  pNew->nRegs = p->nRegs;
   memset( p->pCopy, 0, sizeof(int)*p->nObjs ); int i, k, iLit; // obj2obj
   if ( fRemDangle )  
     Maig_MarkDfs(p);
@@ -657,11 +1229,90 @@ static inline maig * Maig_Dup( maig * p, int fRemDangle )
     if ( fRemDangle && p->pTravIds[i] != p->nTravIds )
       continue;
     p->pCopy[i] = Maig_AppendObj(pNew);
+    Maig_ObjSetKind(pNew, p->pCopy[i], Maig_ObjKind(p, i));
     Maig_ForEachObjFanin( p, i, iLit, k )
       Maig_AppendFanin(pNew, p->pCopy[i], Lit2LitV(p->pCopy, iLit));
   }
   return pNew;
 }
+// packs the AIG into a byte string: the header (inputs, outputs, registers, objects) followed by 
+// the fanin count of each node/output and its fanin literals, each encoded as a varint of the 
+// distance from the object's own literal (the first fanin) or from the previous fanin (zig-zag)
+static inline unsigned char * Maig_PackWrite( unsigned char * pCur, unsigned x )
+{
+  while ( x & ~0x7f ) {
+    *pCur++ = (unsigned char)((x & 0x7f) | 0x80);
+    x >>= 7;
+  }
+  *pCur++ = (unsigned char)x;
+  return pCur;
+}
+static inline unsigned char * Maig_Pack( maig * p, int * pnBytes )
+{
+  int i, k, iLit, iPrev, nFans = 0;
+  assert( p->pKinds == NULL ); // the node kinds are not packed
+  Maig_ForEachNodeOutput( p, i )
+    nFans += Maig_ObjFaninNum(p, i);
+  unsigned char * pData = (unsigned char *)malloc( 5 * (4 + p->nObjs + nFans) ), * pCur = pData;
+  pCur = Maig_PackWrite( pCur, p->nIns );
+  pCur = Maig_PackWrite( pCur, p->nOuts );
+  pCur = Maig_PackWrite( pCur, p->nRegs );
+  pCur = Maig_PackWrite( pCur, p->nObjs );
+  Maig_ForEachNodeOutput( p, i ) {
+    pCur = Maig_PackWrite( pCur, Maig_ObjFaninNum(p, i) );
+    iPrev = Var2Lit(i, 0);
+    Maig_ForEachObjFanin( p, i, iLit, k ) {
+      assert( Lit2Var(iLit) < i );
+      pCur = Maig_PackWrite( pCur, k ? (unsigned)((iLit - iPrev) << 1) ^ (unsigned)((iLit - iPrev) >> 31) : (unsigned)(iPrev - iLit) );
+      iPrev = iLit;
+    }
+  }
+  *pnBytes = (int)(pCur - pData);
+  return (unsigned char *)realloc( pData, *pnBytes );
+}
+static inline maig * Maig_Unpack( unsigned char * pData, int nBytes )
+{
+  unsigned char * pCur = pData, * pEnd = pData + nBytes;
+  int nIns  = Maig_AigerReadUnsigned( &pCur, pEnd );
+  int nOuts = Maig_AigerReadUnsigned( &pCur, pEnd );
+  int nRegs = Maig_AigerReadUnsigned( &pCur, pEnd );
+  int nObjs = Maig_AigerReadUnsigned( &pCur, pEnd );
+  maig * pNew = Maig_Alloc( nIns, nOuts, nObjs ); int i, k, nFans, iLit;
+  pNew->nRegs = nRegs;
+  for ( i = 1 + nIns; i < nObjs; i++ ) {
+    int iObj = Maig_AppendObj(pNew);
+    nFans = Maig_AigerReadUnsigned( &pCur, pEnd );
+    for ( iLit = Var2Lit(iObj, 0), k = 0; k < nFans; k++ ) {
+      unsigned x = (unsigned)Maig_AigerReadUnsigned( &pCur, pEnd );
+      iLit = k ? iLit + (int)((x >> 1) ^ (0 - (x & 1))) : iLit - (int)x;
+      Vi_Push( pNew->pvFans + iObj, iLit );
+    }
+  }
+  assert( pCur == pEnd );
+  return pNew;
+}
+// packs the array of non-negative integers (such as the cached supergates) in the same way
+static inline unsigned char * Maig_PackInts( vi * v, int * pnBytes )
+{
+  unsigned char * pData = (unsigned char *)malloc( 5 * (1 + Vi_Size(v)) ), * pCur = pData; int i;
+  pCur = Maig_PackWrite( pCur, Vi_Size(v) );
+  for ( i = 0; i < Vi_Size(v); i++ ) {
+    assert( Vi_Read(v, i) >= 0 );
+    pCur = Maig_PackWrite( pCur, Vi_Read(v, i) );
+  }
+  *pnBytes = (int)(pCur - pData);
+  return (unsigned char *)realloc( pData, *pnBytes );
+}
+static inline vi * Maig_UnpackInts( unsigned char * pData, int nBytes )
+{
+  unsigned char * pCur = pData, * pEnd = pData + nBytes;
+  int i, nInts = Maig_AigerReadUnsigned( &pCur, pEnd );
+  vi * v = Vi_Alloc( MaxInt(nInts, 1) );
+  for ( i = 0; i < nInts; i++ )
+    Vi_Push( v, Maig_AigerReadUnsigned( &pCur, pEnd ) );
+  assert( pCur == pEnd );
+  return v;
+}
 
 // duplicator to restore the topological order 
 // (the input AIG can have "hidden" internal nodes listed after primary outputs)
@@ -678,6 +1329,7 @@ static inline void Maig_DupDfs_rec( maig * pNew, maig * p, int iObj )
   assert( Maig_ObjFaninNum(p, iObj) > 0 );
   // 3. create current node
   p->pCopy[iObj] = Maig_AppendObj(pNew);
+  Maig_ObjSetKind(pNew, p->pCopy[iObj], Maig_ObjKind(p, iObj));
   // 4. append newly created fanins to the current node    
   Maig_ForEachObjFanin( p, iObj, iLit, i )
     Maig_AppendFanin(pNew, p->pCopy[iObj], Lit2LitV(p->pCopy, iLit));
@@ -685,6 +1337,7 @@ static inline void Maig_DupDfs_rec( maig * pNew, maig * p, int iObj )
 static inline maig * Maig_DupDfs( maig * p )
 {
   maig * pNew = Maig_Alloc( p->nIns, p->nOuts, p->nObjsAlloc );
+  pNew->nRegs = p->nRegs;
   // 1. the array is filled with -1 to distinct visited nodes from unvisited
   memset( p->pCopy, 0xFF, sizeof(int)*p->nObjsAlloc ); int i, k, iLit; // obj2obj
   // for each primary input we mark it with it's index
@@ -830,6 +1483,7 @@ static inline maig * Maig_DupStrash( maig * p, int fCprop, int fStrash )
 {
   int i, k, iLit, nObjsAlloc = 1 + p->nIns + p->nOuts + Maig_CountAnd2(p);
   maig * pTemp, * pNew = Maig_Alloc( p->nIns, p->nOuts, nObjsAlloc );
+  pNew->nRegs = p->nRegs;
   memset( p->pCopy, 0, sizeof(int)*p->nObjs ); // obj2lit
   if ( fStrash ) {
     assert( pNew->pTable == NULL );
@@ -840,6 +1494,16 @@ static inline maig * Maig_DupStrash( maig * p, int fCprop, int fStrash )
     p->pCopy[i] = Var2Lit(i, 0);
   Maig_ForEachNode( p, i ) {
     assert( Maig_ObjFaninNum(p, i) > 0 );
+    if ( !Maig_ObjIsAnd(p, i) ) { // MUX(c, t, e) = ~(~(c & t) & ~(~c & e))
+      int pLits[3], iLit0, iLit1;
+      Maig_ObjMuxFanins( p, i, pLits );
+      for ( k = 0; k < 3; k++ )
+        pLits[k] = Lit2LitL(p->pCopy, pLits[k]);
+      iLit0 = Maig_BuildNode(pNew, pLits[0], pLits[1], fCprop, fStrash);
+      iLit1 = Maig_BuildNode(pNew, LitNot(pLits[0]), pLits[2], fCprop, fStrash);
+      p->pCopy[i] = LitNot( Maig_BuildNode(pNew, LitNot(iLit0), LitNot(iLit1), fCprop, fStrash) );
+      continue;
+    }
     Maig_ForEachObjFanin( p, i, iLit, k )
       if ( k == 0 )
         p->pCopy[i] = Lit2LitL(p->pCopy, iLit);
@@ -881,36 +1545,240 @@ static inline void Maig_CollectSuper_rec( maig * p, int iLit, int * pStop, vi *
     Maig_CollectSuper_rec( p, Maig_ObjFanin1(p, Lit2Var(iLit)), pStop, vSuper );
   }
 }
-static inline maig * Maig_DupMulti( maig * p, int nFaninMax_, int nGrowth )
+// collects the roots of supergates in the DFS order, which places the nodes of each cone next to each other
+static inline void Maig_CollectRoots_rec( maig * p, int iObj, int * pStop, vi * vRoots )
+{
+  if ( p->pTravIds[iObj] == p->nTravIds )
+    return;
+  p->pTravIds[iObj] = p->nTravIds;
+  if ( !Maig_ObjIsNode(p, iObj) )
+    return;
+  Maig_CollectRoots_rec( p, Lit2Var(Maig_ObjFanin0(p, iObj)), pStop, vRoots );
+  Maig_CollectRoots_rec( p, Lit2Var(Maig_ObjFanin1(p, iObj)), pStop, vRoots );
+  if ( pStop[iObj] > 1 )
+    Vi_Push( vRoots, iObj );
+}
+static inline vi * Maig_CollectRoots( maig * p, int * pStop, int fDfsOrder )
+{
+  vi * vRoots = Vi_Alloc( 100 ); int i;
+  if ( fDfsOrder ) {
+    p->nTravIds++;
+    Maig_ForEachOutput( p, i )
+      Maig_CollectRoots_rec( p, Lit2Var(Maig_ObjFanin0(p, i)), pStop, vRoots );
+  }
+  else {
+    Maig_ForEachNode( p, i )
+      if ( pStop[i] != 1 )
+        Vi_Push( vRoots, i );
+  }
+  return vRoots;
+}
+// recognizes the node AND(~AND(c, t), ~AND(~c, e)) = MUX(c, ~t, ~e) and returns its fanins (c, ~t, ~e)
+static inline int Maig_ObjRecognizeMux( maig * p, int i, int * pLits )
+{
+  int k0, k1, iLit0 = Maig_ObjFanin0(p, i), iLit1 = Maig_ObjFanin1(p, i);
+  int iObj0 = Lit2Var(iLit0), iObj1 = Lit2Var(iLit1);
+  if ( !Lit2C(iLit0) || !Lit2C(iLit1) || !Maig_ObjIsNode(p, iObj0) || !Maig_ObjIsNode(p, iObj1) )
+    return 0;
+  for ( k0 = 0; k0 < 2; k0++ )
+  for ( k1 = 0; k1 < 2; k1++ )
+    if ( (Vi_Read(p->pvFans+iObj0, k0) ^ Vi_Read(p->pvFans+iObj1, k1)) == 1 ) {
+      pLits[0] = Vi_Read(p->pvFans+iObj0, k0);
+      pLits[1] = LitNot( Vi_Read(p->pvFans+iObj0, !k0) );
+      pLits[2] = LitNot( Vi_Read(p->pvFans+iObj1, !k1) );
+      return 1;
+    }
+  return 0;
+}
+// marks the roots of XOR/MUX clusters whose two inner nodes have no other fanouts (pKinds) and 
+// updates the stops: the roots and their fanins become stops, while the inner nodes are skipped;
+// the roots are visited from the outputs, so that an inner node is not claimed by another cluster
+static inline int * Maig_MarkXorMux( maig * p, int * pStop )
+{
+  int * pKinds = (int *)calloc( sizeof(int), p->nObjs );
+  int * pRefs = (int *)calloc( sizeof(int), p->nObjs );
+  int i, k, iLit, pLits[3];
+  Maig_ForEachNodeOutput( p, i )
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      pRefs[Lit2Var(iLit)]++;
+  for ( i = p->nObjs - p->nOuts - 1; i > p->nIns; i-- ) {
+    int iObj0 = Lit2Var(Maig_ObjFanin0(p, i)), iObj1 = Lit2Var(Maig_ObjFanin1(p, i));
+    if ( pKinds[i] == -1 || pStop[i] == 0 || !Maig_ObjRecognizeMux(p, i, pLits) )
+      continue;
+    if ( pRefs[iObj0] > 1 || pRefs[iObj1] > 1 || pKinds[iObj0] || pKinds[iObj1] )
+      continue;
+    pKinds[i] = (pLits[1] ^ pLits[2]) == 1 ? MAIG_XOR : MAIG_MUX;
+    pKinds[iObj0] = pKinds[iObj1] = -1;
+    pStop[iObj0]  = pStop[iObj1]  = 1;
+    pStop[i] = MaxInt( pStop[i], 2 );
+    for ( k = 0; k < 3; k++ )
+      pStop[Lit2Var(pLits[k])] = MaxInt( pStop[Lit2Var(pLits[k])], 2 );
+  }
+  free( pRefs );
+  return pKinds;
+}
+// the supergates are collected once for each AIG and cached as the entries
+// (root, capacity, size, fanin limit, growth, literals), where the literals are those of this AIG;
+// after the first decomposition, they are listed in the order used to build the cascade;
+// the XOR/MUX clusters are cached as the entries with the fanin limit 0, the node kind in place 
+// of the growth, and the literals (a, b) or (c, t, e)
+#define RW_SUPER_HEAD 5
+static inline vi * Maig_CollectSupers( maig * p, int fDfsOrder, int fXorMux )
+{
+  int i, r, * pStop, * pKinds = NULL, pLits[3], nLits; vi * vRoots, * vArray;
+  if ( p->vSupers && p->fSupersDfs == (fDfsOrder | (fXorMux << 1)) )
+    return p->vSupers;
+  if ( p->vSupers )
+    Vi_Free( p->vSupers );
+  p->vSupers    = Vi_Alloc( 4 * p->nObjs );
+  p->fSupersDfs = fDfsOrder | (fXorMux << 1);
+  pStop  = Maig_CreateStops( p );
+  if ( fXorMux )
+    pKinds = Maig_MarkXorMux( p, pStop );
+  vRoots = Maig_CollectRoots( p, pStop, fDfsOrder );
+  vArray = Vi_Alloc( 100 );
+  Maig_ForEachObj( p, i )
+    p->pCopy[i] = Var2Lit(i, 0);
+  Vi_ForEachEntry( vRoots, i, r ) {
+    assert( pStop[i] > 1 ); // no dangling
+    if ( pKinds && pKinds[i] > 0 ) {
+      Maig_ObjRecognizeMux( p, i, pLits );
+      if ( pKinds[i] == MAIG_XOR ) // MUX(a, ~b, b) = XOR(a, b)
+        pLits[1] = pLits[2];
+      nLits = pKinds[i] == MAIG_XOR ? 2 : 3;
+      Vi_Push( p->vSupers, i );
+      Vi_PushTwo( p->vSupers, nLits, nLits );
+      Vi_PushTwo( p->vSupers, 0, pKinds[i] );
+      Vi_PushArray( p->vSupers, pLits, nLits );
+      continue;
+    }
+    Vi_Shrink(vArray, 0);
+    Maig_CollectSuper_rec( p, Maig_ObjFanin0(p, i), pStop, vArray );
+    Maig_CollectSuper_rec( p, Maig_ObjFanin1(p, i), pStop, vArray );
+    assert( Vi_Size(vArray) > 1 );
+    Vi_Push( p->vSupers, i );
+    Vi_PushTwo( p->vSupers, Vi_Size(vArray), Vi_Size(vArray) );
+    Vi_PushTwo( p->vSupers, 0, 0 ); // not decomposed yet
+    Vi_PushArray( p->vSupers, Vi_Array(vArray), Vi_Size(vArray) );
+  }
+  Vi_Free( vRoots );
+  Vi_Free( vArray );
+  if ( pKinds ) free( pKinds );
+  free( pStop );
+  return p->vSupers;
+}
+// the percentage of the XOR/MUX clusters kept as single nodes in each iteration; the others are 
+// unfolded into AND2 nodes with space for new fanins, so that the clusters can still be restructured
+#define RW_XORMUX_KEEP 50
+
+// returns the literals (c, t, e) of the XOR/MUX cluster in the new AIG (or 0 if their variables are not distinct)
+static inline int Maig_MuxCopyLits( maig * p, int * pEntry, int * pFans )
+{
+  int * pLits = pEntry + RW_SUPER_HEAD;
+  pFans[0] = Lit2LitL( p->pCopy, pLits[0] );
+  pFans[2] = Lit2LitL( p->pCopy, pLits[pEntry[4] == MAIG_XOR ? 1 : 2] );
+  pFans[1] = pEntry[4] == MAIG_XOR ? LitNot(pFans[2]) : Lit2LitL( p->pCopy, pLits[1] ); // MUX(c, ~e, e) = XOR(c, e)
+  return Lit2Var(pFans[0]) != Lit2Var(pFans[1]) && Lit2Var(pFans[0]) != Lit2Var(pFans[2]) && (pEntry[4] == MAIG_XOR || Lit2Var(pFans[1]) != Lit2Var(pFans[2]));
+}
+// returns the inner node of the XOR/MUX cluster that has the given control literal
+static inline int Maig_ObjInnerMux( maig * p, int iRoot, int iLitC )
+{
+  int iObj0 = Lit2Var(Maig_ObjFanin0(p, iRoot));
+  return Vi_Find( p->pvFans+iObj0, iLitC ) >= 0 ? iObj0 : Lit2Var(Maig_ObjFanin1(p, iRoot));
+}
+// decomposes the supergates into multi-input nodes; a supergate decomposed before 
+// reuses its cascade unless it is among the nRedecomp percent selected for re-decomposition
+static inline maig * Maig_DupMulti( maig * p, int nFaninMax_, int nGrowth, int fDfsOrder, int fXorMux, int nRedecomp, rw_rng * pRng )
 {
   maig * pNew = Maig_Alloc( p->nIns, p->nOuts, p->nObjs );
-  int * pStop = Maig_CreateStops(p); int i, k, iLit;
+  pNew->nRegs = p->nRegs;
+  vi * vSupers = Maig_CollectSupers( p, fDfsOrder, fXorMux );
   vi * vArray = Vi_Alloc( 100 );
+  int * pInv = (int *)malloc( sizeof(int)*p->nObjs ); // maps new nodes into the literals of this AIG
+  int i, k, e, iLit, * pEntry, * pLits, nFaninMaxLocal, nGrowthLocal, pFans[3];
   assert( nFaninMax_ >= 2 && nGrowth >= 1 );
   memset( p->pCopy, 0, sizeof(int)*p->nObjs ); // obj2lit
   Maig_ForEachConstInput( p, i )
-    p->pCopy[i] = Var2Lit(i, 0);  
-  Maig_ForEachNode( p, i ) {
-    if ( pStop[i] == 1 )
-       continue;
-    assert( pStop[i] > 1 ); // no dangling
+    p->pCopy[i] = pInv[i] = Var2Lit(i, 0);  
+  for ( e = 0; e < Vi_Size(vSupers); e += RW_SUPER_HEAD + pEntry[1] ) {
+    pEntry = Vi_Array(vSupers) + e;
+    pLits  = pEntry + RW_SUPER_HEAD;
+    i      = pEntry[0];
+    if ( pEntry[3] == 0 && pEntry[4] && (int)Rng_Bound(pRng, 100) >= RW_XORMUX_KEEP && Maig_MuxCopyLits(p, pEntry, pFans) ) { 
+      // the cluster is unfolded into ~MUX(c, t, e) = AND( ~AND(c, ~t), ~AND(~c, ~e) ) with space for new fanins
+      int pObjs[3], c = pFans[0];
+      for ( k = 0; k < 3; k++ ) {
+        vi * vFanins = pNew->pvFans + (pObjs[k] = Maig_AppendObj(pNew));
+        assert( vFanins->ptr == NULL );
+        vFanins->cap = 2 + 1 + Rng_Bound(pRng, nGrowth);
+        vFanins->ptr = (int*)malloc( sizeof(int)*vFanins->cap );
+        if ( k < 2 ) {
+          Maig_AppendFanin( pNew, pObjs[k], LitNotC(c, k) );
+          Maig_AppendFanin( pNew, pObjs[k], LitNot(pFans[1+k]) );
+        }
+        else {
+          Maig_AppendFanin( pNew, pObjs[k], Var2Lit(pObjs[0], 1) );
+          Maig_AppendFanin( pNew, pObjs[k], Var2Lit(pObjs[1], 1) );
+        }
+        pInv[pObjs[k]] = Var2Lit(k < 2 ? Maig_ObjInnerMux(p, i, LitNotC(pLits[0], k)) : i, 0);
+      }
+      p->pCopy[i] = Var2Lit(pObjs[2], 0);
+      continue;
+    }
+    if ( pEntry[3] == 0 && pEntry[4] ) { // XOR/MUX node without space for new fanins
+      int iObj = Maig_AppendObj(pNew), fCompl = 0;
+      for ( k = 0; k < pEntry[2]; k++ )
+        pFans[k] = Lit2LitL(p->pCopy, pLits[k]);
+      if ( pEntry[4] == MAIG_XOR ) { // the fanins are not complemented
+        fCompl   = Lit2C(pFans[0]) ^ Lit2C(pFans[1]);
+        pFans[0] = Var2Lit(Lit2Var(pFans[0]), 0);
+        pFans[1] = Var2Lit(Lit2Var(pFans[1]), 0);
+      }
+      else if ( Lit2C(pFans[0]) ) { // the control is not complemented
+        pFans[0] = LitNot(pFans[0]);
+        RW_SWAP( int, pFans[1], pFans[2] );
+      }
+      vi * vFanins = pNew->pvFans + iObj;
+      assert( vFanins->ptr == NULL );
+      vFanins->cap = pEntry[2];
+      vFanins->ptr = (int*)malloc( sizeof(int)*vFanins->cap );
+      Maig_ObjSetKind( pNew, iObj, pEntry[4] );
+      for ( k = 0; k < pEntry[2]; k++ )
+        Maig_AppendFanin( pNew, iObj, pFans[k] );
+      p->pCopy[i] = Var2Lit(iObj, fCompl);
+      pInv[iObj]  = Var2Lit(i, fCompl);
+      continue;
+    }
     Vi_Shrink(vArray, 0);
-    Maig_CollectSuper_rec( p, Maig_ObjFanin0(p, i), pStop, vArray );
-    Maig_CollectSuper_rec( p, Maig_ObjFanin1(p, i), pStop, vArray );
-    assert( Vi_Size(vArray) > 1 );
-    Maig_ReduceFanins(vArray);
-    assert( Vi_Size(vArray) > 0 );
+    for ( k = 0; k < pEntry[2]; k++ )
+      Vi_Push( vArray, Lit2LitL(p->pCopy, pLits[k]) );
+    if ( pEntry[3] && pEntry[3] <= nFaninMax_ && pEntry[4] <= nGrowth && nRedecomp < 100 && (int)Rng_Bound(pRng, 100) >= nRedecomp ) {
+      nFaninMaxLocal = pEntry[3];
+      nGrowthLocal   = pEntry[4];
+    }
+    else {
+      Maig_ReduceFanins(vArray);
+      assert( Vi_Size(vArray) > 0 );
+      nFaninMaxLocal = nGrowthLocal = 1;
+      if ( Vi_Size(vArray) > 1 ) {
+        nFaninMaxLocal = 2 + Rng_Bound(pRng, nFaninMax_-1);
+        nGrowthLocal   = 1 + Rng_Bound(pRng, nGrowth);
+        assert( nFaninMaxLocal >= 2 && nFaninMaxLocal <= nFaninMax_ );
+        assert( nGrowthLocal   >= 1 && nGrowthLocal   <= nGrowth );
+        if ( Vi_Size(vArray) > nFaninMaxLocal )
+          Vi_Randomize(vArray, pRng);
+      }
+      // remember the decomposition
+      pEntry[2] = Vi_Size(vArray);
+      pEntry[3] = nFaninMaxLocal;
+      pEntry[4] = nGrowthLocal;
+      Vi_ForEachEntry( vArray, iLit, k )
+        pLits[k] = Lit2LitL(pInv, iLit);
+    }
     if ( Vi_Size(vArray) == 1 ) 
       p->pCopy[i] = Vi_Read(vArray, 0);
     else
     {
-      int nFaninMaxLocal = 2 + (Random_Num(0) % (nFaninMax_-1));
-      int nGrowthLocal   = 1 + (Random_Num(0) % nGrowth);
-      assert( nFaninMaxLocal >= 2 && nFaninMaxLocal <= nFaninMax_ );
-      assert( nGrowthLocal   >= 1 && nGrowthLocal   <= nGrowth );
-      
-      if ( Vi_Size(vArray) > nFaninMaxLocal )
-        Vi_Randomize(vArray);
       // create a cascade of nodes
       while ( Vi_Size(vArray) > nFaninMaxLocal )
       {
@@ -936,12 +1804,13 @@ static inline maig * Maig_DupMulti( maig * p, int nFaninMax_, int nGrowth )
         Maig_AppendFanin( pNew, iObj, iLit );
       assert( Vi_Space(vFanins) == nGrowthLocal );
       p->pCopy[i] = Var2Lit(iObj, 0);
+      pInv[iObj]  = Var2Lit(i, 0);
     }
   }
   Maig_ForEachOutput( p, i ) 
     Maig_AppendFanin(pNew, Maig_AppendObj(pNew), Lit2LitL(p->pCopy, Maig_ObjFanin0(p, i)));
-  Vi_Stop( vArray );
-  free( pStop );
+  Vi_Free( vArray );
+  free( pInv );
   return pNew;
 }
 
@@ -981,9 +1850,10 @@ static inline int Rw_FindPair( vi * vPair )
   //if ( iBest >= 0 ) printf( "Extracting pair (%d, %d) used %d times.\n", pArray[iBest], pArray[iBest+1], pArray[iBest+2] );
   return iBest;
 }
-// updates one fanin array by replacing the pair with a new literal (iLit)
-static inline int Rw_UpdateFanins( vi * vFans, int iFan1, int iFan2, int iLit )
+// updates the fanin array of the node by replacing the pair with a new literal (iLit)
+static inline int Rw_UpdateFanins( maig * p, int iObj, int iFan1, int iFan2, int iLit )
 {
+  vi * vFans = p->pvFans + iObj;
   int i, f1, f2, iFan1_, iFan2_;
   Vi_ForEachEntry( vFans, iFan1_, f1 )
   if ( iFan1_ == iFan1 )
@@ -991,6 +1861,7 @@ static inline int Rw_UpdateFanins( vi * vFans, int iFan1, int iFan2, int iLit )
   if ( iFan2_ == iFan2 )
   {
     assert( f1 < f2 );
+    Maig_JournalSave( p, iObj );
     Vi_Drop( vFans, f2 );
     Vi_Drop( vFans, f1 );
     Vi_Push( vFans, iLit );
@@ -1009,7 +1880,8 @@ static inline void Rw_ExtractBest( maig * p, vi * vPairs )
   Maig_AppendFanin( p, iObj, pArray[iBest] );
   Maig_AppendFanin( p, iObj, pArray[iBest+1] );
   Maig_ForEachNode( p, i )
-    Counter += Rw_UpdateFanins( p->pvFans+i, pArray[iBest], pArray[iBest+1], Var2Lit(iObj, 0) );
+    if ( Maig_ObjIsAnd(p, i) )
+      Counter += Rw_UpdateFanins( p, i, pArray[iBest], pArray[iBest+1], Var2Lit(iObj, 0) );
   assert( Counter == pArray[iBest+2] );
 }
 // find the set of all pairs that appear more than once
@@ -1020,6 +1892,8 @@ static inline vi * Rw_FindPairs( maig * p, word * pSto, int nWords )
   Maig_ForEachNode( p, i )
   {
     vi * vFans = p->pvFans+i;
+    if ( !Maig_ObjIsAnd(p, i) ) // the pairs are only shared among the ANDs
+      continue;
     Vi_ForEachEntry( vFans, iFan1, f1 ) {
       word * pRowFan1 = pSto + iFan1*nWords;
       Vi_ForEachEntryStart( vFans, iFan2, f2, f1+1 )
@@ -1041,6 +1915,10 @@ static inline int Rw_FindShared( maig * p, int nNewNodesMax )
     p->pvFans     =  (vi *)realloc( (void *)p->pvFans, sizeof(vi) *p->nObjsAlloc );
     memset( p->pCopy+p->nObjs,  0, sizeof(int)*(p->nObjsAlloc-p->nObjs) );
     memset( p->pvFans+p->nObjs, 0, sizeof(vi) *(p->nObjsAlloc-p->nObjs) );
+    if ( p->pKinds ) {
+      p->pKinds = (char *)realloc( (void *)p->pKinds, sizeof(char)*p->nObjsAlloc );
+      memset( p->pKinds+p->nObjs, 0, sizeof(char)*(p->nObjsAlloc-p->nObjs) );
+    }
   }
   assert( sizeof(word) == 8 );
   int i, nWords = (2*p->nObjsAlloc + 63)/64; // how many words are needed to have a bitstring with one bit for each literal
@@ -1061,18 +1939,21 @@ static inline int Rw_FindShared( maig * p, int nNewNodesMax )
   free( pSto );
   return i;
 }
-// perform shared logic extraction
+// perform shared logic extraction (the edits of the network are undone using the journal)
 static inline maig * Rw_Share( maig * p, int nNewNodesMax )
 {
-  maig * pNew, * pCopy = Maig_Dup(p, 0);
-  int nNewNodes = Rw_FindShared( pCopy, nNewNodesMax );
-  if ( nNewNodes == 0 )
-    return pCopy;
+  maig * pNew;
+  Maig_JournalStart( p );
+  int nNewNodes = Rw_FindShared( p, nNewNodesMax );
+  if ( nNewNodes == 0 ) {
+    Maig_JournalStop( p );
+    return Maig_Dup( p, 0 );
+  }
   // temporarily create "hidden" nodes for DFS duplicator
-  pCopy->nObjs -= nNewNodes;
-  pNew = Maig_DupDfs( pCopy );
-  pCopy->nObjs += nNewNodes;
-  Maig_Free( pCopy );
+  p->nObjs -= nNewNodes;
+  pNew = Maig_DupDfs( p );
+  p->nObjs += nNewNodes;
+  Maig_JournalUndo( p );
   return pNew;
 }
 
@@ -1080,73 +1961,365 @@ static inline maig * Rw_Share( maig * p, int nNewNodesMax )
                    care-set computation
 **************************************************************/
 
-static inline word * Maig_ObjTruth( maig *p, int i, int n )  { return p->pTruths[n] + p->nWords*i;    }
 static inline int    Maig_ObjType( maig *p, int i )          { return p->pTravIds[i] == p->nTravIds;  }
 
-// compute truth table of the node
-static inline void Maig_TruthSimNode( maig * p, int i )
-{
-  int k, iLit;  
+// With the memory limit, the tables of the objects (table 0 is the function, table 1 is the function 
+// under the complemented node whose care set is computed) are kept in a fixed number of slots.
+// The slots are reused in the clock order and the missing tables are recomputed from the fanins.
+// The pointer to a table is only valid until the next table is accessed, unless the slot is locked.
+// If all slots are locked, new slots are added beyond the limit (the tables of the slots never move).
+static inline word * Maig_TruthFetch( maig * p, int i, int n );
+
+static inline word * Maig_ObjTruth( maig *p, int i, int n )  { return p->nSlots ? Maig_TruthFetch(p, i, n) : p->pTruths[n] + p->nWords*i; }
+static inline word * Maig_ObjTruthSpec( maig *p, int i )     { return p->pTruths[2] + p->nWords*(i - (p->nObjs - p->nOuts));               }
+static inline word * Maig_ObjCareSpec( maig *p, int i )      { return p->pCareOuts + p->nWords*(i - (p->nObjs - p->nOuts));                }
+static inline void   Maig_TruthLock( maig *p, int i, int n ) { if ( p->nSlots ) p->pSlotPins[p->pSlots[2*i+n]]++;                          }
+static inline void   Maig_TruthUnlock( maig *p, int i, int n ){ if ( p->nSlots ) p->pSlotPins[p->pSlots[2*i+n]]--;                         }
+
+static inline void Maig_TruthStartSlots( maig * p, int nSlots )
+{
+  int s;
+  assert( p->nSlots == 0 );
+  p->nSlots    = nSlots;
+  p->nSlotsBase= nSlots;
+  p->iSlotHand = 0;
+  p->pSlots    = (int *)malloc( sizeof(int) * 2 * p->nObjs );
+  p->pSlotKeys = (int *)malloc( sizeof(int) * nSlots );
+  p->pSlotPins = (int *)calloc( sizeof(int), nSlots );
+  p->pSlotRefs = (int *)calloc( sizeof(int), nSlots );
+  p->pSlotGens = (int *)calloc( sizeof(int), nSlots );
+  p->pSlotData = (word **)malloc( sizeof(word *) * nSlots );
+  p->pTruths[0]= (word *)calloc( sizeof(word), p->nWords*nSlots );
+  memset( p->pSlots, 0xFF, sizeof(int) * 2 * p->nObjs );
+  for ( s = 0; s < nSlots; s++ ) {
+    p->pSlotKeys[s] = -1;
+    p->pSlotData[s] = p->pTruths[0] + p->nWords*s;
+  }
+}
+// adds the slots allocated one by one, so that the locked tables stay in place
+static inline void Maig_TruthSlotGrow( maig * p )
+{
+  int s, nSlots = p->nSlots + MaxInt( 16, p->nSlots / 8 );
+  p->pSlotKeys = (int *)realloc( p->pSlotKeys, sizeof(int) * nSlots );
+  p->pSlotPins = (int *)realloc( p->pSlotPins, sizeof(int) * nSlots );
+  p->pSlotRefs = (int *)realloc( p->pSlotRefs, sizeof(int) * nSlots );
+  p->pSlotGens = (int *)realloc( p->pSlotGens, sizeof(int) * nSlots );
+  p->pSlotData = (word **)realloc( p->pSlotData, sizeof(word *) * nSlots );
+  for ( s = p->nSlots; s < nSlots; s++ ) {
+    p->pSlotKeys[s] = -1;
+    p->pSlotPins[s] = p->pSlotRefs[s] = p->pSlotGens[s] = 0;
+    p->pSlotData[s] = (word *)calloc( sizeof(word), p->nWords );
+  }
+  p->iSlotHand = p->nSlots;
+  p->nSlots    = nSlots;
+}
+// reports (once per run) that the tables locked at the same time did not fit into the memory limit
+static inline void Maig_TruthSlotWarn( maig * p, int * pfWarned )
+{
+  if ( p->nSlots == p->nSlotsBase || *pfWarned )
+    return;
+  *pfWarned = 1;
+  printf( "The memory limit (%d MB) is exceeded by %d truth tables locked at the same time (the run continues).\n", p->nMemLimit, p->nSlots - p->nSlotsBase );
+}
+// finds an unlocked slot that was not recently used and assigns it to the table
+static inline int Maig_TruthSlotAlloc( maig * p, int Key )
+{
+  int s, nSteps;
+  if ( (s = p->pSlots[Key]) >= 0 ) { // reuse the slot of the outdated table
+    p->pSlotRefs[s] = 1;
+    p->pSlotGens[s] = p->nTravIds;
+    return s;
+  }
+  for ( nSteps = 0; nSteps < 3 * p->nSlots; nSteps++ ) {
+    s = p->iSlotHand;
+    p->iSlotHand = (p->iSlotHand + 1) % p->nSlots;
+    if ( p->pSlotPins[s] )
+      continue;
+    if ( p->pSlotRefs[s] ) {
+      p->pSlotRefs[s] = 0;
+      continue;
+    }
+    if ( p->pSlotKeys[s] >= 0 && p->pSlots[p->pSlotKeys[s]] == s )
+      p->pSlots[p->pSlotKeys[s]] = -1;
+    p->pSlotKeys[s] = Key;
+    p->pSlots[Key]  = s;
+    p->pSlotRefs[s] = 1;
+    p->pSlotGens[s] = p->nTravIds;
+    return s;
+  }
+  Maig_TruthSlotGrow( p );
+  return Maig_TruthSlotAlloc( p, Key );
+}
+// returns the slot of the table if it is stored
+static inline int Maig_TruthSlotFind( maig * p, int i, int n )
+{
+  int s = p->pSlots[2*i+n];
+  if ( s < 0 || (n == 1 && p->pSlotGens[s] != p->nTravIds) ) // tables 1 are only valid for the current care set
+    return -1;
+  p->pSlotRefs[s] = 1;
+  return s;
+}
+// returns the table to be overwritten (no recomputation)
+static inline word * Maig_ObjTruthNew( maig * p, int i, int n )
+{
+  if ( !p->nSlots )
+    return p->pTruths[n] + p->nWords*i;
+  int s = Maig_TruthSlotFind( p, i, n );
+  if ( s < 0 )
+    s = Maig_TruthSlotAlloc( p, 2*i+n );
+  p->pSlotGens[s] = p->nTravIds;
+  return p->pSlotData[s];
+}
+// computes the table of the XOR/MUX node from the tables of its fanins
+static inline void Maig_TruthSimKind( maig * p, int i, word * pOut, word ** pFans, int nWords )
+{
+  int * pLits = Vi_Array(p->pvFans+i), fSwap = Lit2C(pLits[0]); // the complemented control swaps the data inputs
+  if ( Maig_ObjIsMux(p, i) )
+    Tt_MuxC( pOut, pFans[0], pFans[1+fSwap], Lit2C(pLits[1+fSwap]), pFans[2-fSwap], Lit2C(pLits[2-fSwap]), nWords );
+  else
+    Tt_XorC( pOut, pFans[0], pFans[1], Lit2C(pLits[0]) ^ Lit2C(pLits[1]), nWords );
+}
+// returns the table of the object, recomputing it from the fanins if it is not stored
+static inline word * Maig_TruthFetch( maig * p, int i, int n )
+{
+  int k, iLit, s = Maig_TruthSlotFind( p, i, n );
+  if ( s >= 0 )
+    return p->pSlotData[s];
+  s = Maig_TruthSlotAlloc( p, 2*i+n );
+  p->pSlotPins[s]++;
+  word * pOut = p->pSlotData[s];
+  if ( i == 0 )
+    Tt_Clear( pOut, p->nWords );
+  else if ( Maig_ObjIsPi(p, i) )
+    Tt_ElemInit( pOut, i-1, p->nWords );
+  else if ( n == 1 && i == p->iCareObj )
+    Tt_Not( pOut, Maig_TruthFetch(p, i, 0), p->nWords );
+  else if ( !Maig_ObjIsAnd(p, i) ) {
+    word * pFans[3];
+    Maig_ForEachObjFanin( p, i, iLit, k ) {
+      pFans[k] = Maig_TruthFetch( p, Lit2Var(iLit), n ? Maig_ObjType(p, Lit2Var(iLit)) : 0 );
+      Maig_TruthLock( p, Lit2Var(iLit), n ? Maig_ObjType(p, Lit2Var(iLit)) : 0 );
+    }
+    Maig_TruthSimKind( p, i, pOut, pFans, p->nWords );
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      Maig_TruthUnlock( p, Lit2Var(iLit), n ? Maig_ObjType(p, Lit2Var(iLit)) : 0 );
+  }
+  else
+    Maig_ForEachObjFanin( p, i, iLit, k ) {
+      int Type = n ? Maig_ObjType(p, Lit2Var(iLit)) : 0;
+      if ( k == 0 )
+        Tt_DupC( pOut, Maig_TruthFetch(p, Lit2Var(iLit), Type), Lit2C(iLit), p->nWords );
+      else
+        Tt_Sharp( pOut, Maig_TruthFetch(p, Lit2Var(iLit), Type), Lit2C(iLit), p->nWords );
+    }
+  p->pSlotPins[s]--;
+  return pOut;
+}
+
+// the number of words simulated at a time when the truth tables are processed block by block
+#define RW_BLOCK_WORDS 64
+
+static inline int    Maig_TruthBlock( maig *p, int nWords )  { return (p->fBlocked && !p->nSlots && nWords > RW_BLOCK_WORDS) ? RW_BLOCK_WORDS : nWords; }
+
+// A function that does not depend on the inputs after the (n-1)-th one has the truth table repeating 
+// every Tt_WordNum(n) words. The period of each object is derived from its fanins whenever the node 
+// is simulated, and the tables of at least RW_PERIOD_WORDS words are computed only for one period,
+// which is then copied over the rest of the table (this saves reading the tables of the fanins).
+#define RW_PERIOD_WORDS 32
+
+static inline int Maig_ObjPeriodFanins( maig * p, int i )
+{
+  int k, iLit, nPeriod = 1;
   Maig_ForEachObjFanin( p, i, iLit, k )
-    if ( k == 0 )
-      Tt_DupC( Maig_ObjTruth(p, i, Maig_ObjType(p,i)), Maig_ObjTruth(p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit))), Lit2C(iLit), p->nWords );
-    else
-      Tt_Sharp( Maig_ObjTruth(p, i, Maig_ObjType(p,i)), Maig_ObjTruth(p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit))), Lit2C(iLit), p->nWords );
+    nPeriod = MaxInt( nPeriod, p->pPeriods[Lit2Var(iLit)] );
+  return nPeriod;
+}
+static inline void Maig_TruthStartPeriods( maig * p )
+{
+  int i;
+  p->pPeriods = (int *)malloc( sizeof(int) * p->nObjs );
+  Maig_ForEachConstInput( p, i )
+    p->pPeriods[i] = Tt_WordNum(i);
+  Maig_ForEachNodeOutput( p, i )
+    p->pPeriods[i] = Maig_ObjPeriodFanins( p, i );
+}
+// compute the block of truth table of the node starting at word iWord
+// (the first block updates the period of the node, which is only used if the block is the whole table)
+RW_INLINE void Maig_TruthSimNodeRange( maig * p, int i, int iWord, int nWords )
+{
+  int k, iLit, Type = Maig_ObjType(p,i), nPeriod = nWords;
+  word * pOut = Maig_ObjTruthNew(p, i, Type) + iWord;
+  if ( iWord == 0 && Type == 0 )
+    p->pPeriods[i] = Maig_ObjPeriodFanins( p, i );
+  if ( iWord == 0 && nWords >= RW_PERIOD_WORDS && nWords == p->nWords )
+    nPeriod = p->pPeriods[i];
+  Maig_TruthLock( p, i, Type );
+  if ( !Maig_ObjIsAnd(p, i) ) { // the tables of all fanins are used at once
+    word * pFans[3];
+    Maig_ForEachObjFanin( p, i, iLit, k ) {
+      pFans[k] = Maig_ObjTruth(p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit))) + iWord;
+      Maig_TruthLock( p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit)) );
+    }
+    Maig_TruthSimKind( p, i, pOut, pFans, nPeriod );
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      Maig_TruthUnlock( p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit)) );
+  }
+  else {
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      if ( k == 0 )
+        Tt_DupC( pOut, Maig_ObjTruth(p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit))) + iWord, Lit2C(iLit), nPeriod );
+      else
+        Tt_Sharp( pOut, Maig_ObjTruth(p, Lit2Var(iLit), Maig_ObjType(p,Lit2Var(iLit))) + iWord, Lit2C(iLit), nPeriod );
+  }
+  if ( nPeriod < nWords )
+    Tt_Replicate( pOut, nPeriod, nWords );
+  Maig_TruthUnlock( p, i, Type );
+}
+// compute truth table of the node
+RW_INLINE void Maig_TruthSimNode( maig * p, int i, int nWords )
+{
+  Maig_TruthSimNodeRange( p, i, 0, nWords );
 }
 // compute truth table of the node using a subset of its current fanin
-static inline word * Maig_TruthSimNodeSubset( maig * p, int i, int m )
+RW_INLINE word * Maig_TruthSimNodeSubset( maig * p, int i, int m, int nWords )
 {
-  int k, iLit, Counter = 0; assert( m > 0 );
+  int k, iLit, Counter = 0, nPeriod = 1; assert( m > 0 );
+  if ( nWords >= RW_PERIOD_WORDS ) {
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      if ( (m >> k) & 1 )
+        nPeriod = MaxInt( nPeriod, p->pPeriods[Lit2Var(iLit)] );
+  }
+  else
+    nPeriod = nWords;
   Maig_ForEachObjFanin( p, i, iLit, k )
     if ( (m >> k) & 1 ) { // fanin is included in the subset
       if ( Counter++ == 0 )
-        Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), p->nWords );
+        Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), nPeriod );
       else
-        Tt_Sharp( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), p->nWords );
+        Tt_Sharp( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), nPeriod );
     }
   assert( Counter == Tt_BitCount16(m) );
+  if ( nPeriod < nWords )
+    Tt_Replicate( p->pProd, nPeriod, nWords );
   return p->pProd;
 }
-static inline word * Maig_TruthSimNodeSubset2( maig * p, int i, vi * vFanins, int nFanins )
+RW_INLINE word * Maig_TruthSimNodeSubset2( maig * p, int i, vi * vFanins, int nFanins, int nWords )
 {
-  int k, iLit;
+  int k, iLit, nPeriod = 1;
+  if ( nWords >= RW_PERIOD_WORDS ) {
+    Vi_ForEachEntryStop( vFanins, iLit, k, nFanins )
+      nPeriod = MaxInt( nPeriod, p->pPeriods[Lit2Var(iLit)] );
+  }
+  else
+    nPeriod = nWords;
   Vi_ForEachEntryStop( vFanins, iLit, k, nFanins )
     if ( k == 0 )
-      Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), p->nWords );
+      Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), nPeriod );
     else
-      Tt_Sharp( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), p->nWords );
+      Tt_Sharp( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), nPeriod );
+  if ( nPeriod < nWords )
+    Tt_Replicate( p->pProd, nPeriod, nWords );
   return p->pProd;
 }
-static inline void Maig_TruthInitialize( maig * p )
+// the smallest truth table (in words) and the smallest work (in node words) simulated by several threads
+#define RW_PAR_WORDS 256
+#define RW_PAR_WORK  (1 << 16)
+
+// simulate the nodes in the word range [iWord, iWord+nWords) block by block (the nodes are the entries 
+// of vNodes starting from iStart or, if vNodes is NULL, the objects starting from iStart);
+// if fCare is set, the care set of the node p->iCareObj is accumulated from the outputs
+RW_INLINE void Maig_TruthSimRange( maig * p, vi * vNodes, int iStart, int fCare, int iWord, int nWords )
 {
-  int i, k, iLit;
+  int k, iTemp, w, nStop = vNodes ? Vi_Size(vNodes) : p->nObjs, nBlock = Maig_TruthBlock( p, nWords );
+  for ( w = iWord; w < iWord + nWords; w += nBlock ) {
+    int nBlockW = MinInt( nBlock, iWord + nWords - w );
+    for ( k = iStart; k < nStop; k++ ) {
+      iTemp = vNodes ? Vi_Read(vNodes, k) : k;
+      Maig_TruthSimNodeRange( p, iTemp, w, nBlockW );
+      if ( fCare && Maig_ObjIsPo(p, iTemp) ) {
+        word * pNeg = Maig_ObjTruth( p, iTemp, 1 );
+        Maig_TruthLock( p, iTemp, 1 );
+        if ( p->pCareOuts ) // only the minterms in the external care set of the output are observable
+          Tt_OrXorAnd( p->pCare + w, Maig_ObjTruth(p, iTemp, 0) + w, pNeg + w, Maig_ObjCareSpec(p, iTemp) + w, nBlockW );
+        else
+          Tt_OrXor( p->pCare + w, Maig_ObjTruth(p, iTemp, 0) + w, pNeg + w, nBlockW );
+        Maig_TruthUnlock( p, iTemp, 1 );
+      }
+    }
+  }
+}
+// the simulation job: each thread simulates all nodes in its own range of words
+typedef struct rw_sim_ {
+  maig *  p;
+  vi *    vNodes;
+  int     iStart;
+  int     fCare;
+  int     nWords;
+} rw_sim;
+static void Maig_TruthSimJob( void * pArg, int iThread, int nThreads )
+{
+  rw_sim * pSim = (rw_sim *)pArg;
+  int nChunk = ((pSim->nWords + nThreads - 1) / nThreads + 7) & ~7; // cache-line aligned
+  int iWord  = MinInt( iThread * nChunk, pSim->nWords );
+  Maig_TruthSimRange( pSim->p, pSim->vNodes, pSim->iStart, pSim->fCare, iWord, MinInt(nChunk, pSim->nWords - iWord) );
+}
+// simulate the nodes on all words; large tables are split among the threads 
+// (the ranges of words are disjoint, so the threads only wait for each other at the end)
+RW_INLINE void Maig_TruthSim( maig * p, vi * vNodes, int iStart, int fCare, int nWords )
+{
+  int nNodes = (vNodes ? Vi_Size(vNodes) : p->nObjs) - iStart;
+  if ( p->pPool && p->pPool->nThreads > 1 && !p->nSlots && nWords >= RW_PAR_WORDS && (iword)nNodes * nWords >= RW_PAR_WORK ) {
+    rw_sim Sim = { p, vNodes, iStart, fCare, nWords };
+    Rw_PoolRun( p->pPool, Maig_TruthSimJob, &Sim );
+  }
+  else
+    Maig_TruthSimRange( p, vNodes, iStart, fCare, 0, nWords );
+}
+RW_INLINE void Maig_TruthInitialize( maig * p, int nWords )
+{
+  int i;
   if ( p->pTruths[0] ) 
     return;
-  p->pTruths[0] = (word *)calloc( sizeof(word), p->nWords*p->nObjs );
-  p->pTruths[1] = (word *)calloc( sizeof(word), p->nWords*p->nObjs );
-  p->pTruths[2] = (word *)calloc( sizeof(word), p->nWords*p->nObjs );
+  int nTables = 2*p->nObjs + p->nOuts + 2; // two tables per object, output specs, care set and product
+  float MemMB = 8.0*p->nWords*nTables/(1<<20);
+  if ( p->nMemLimit && MemMB > p->nMemLimit ) {
+    int nSlots    = (int)(((word)p->nMemLimit << 20) / (8*p->nWords)) - p->nOuts - 2;
+    int nSlotsMin = 2 * Maig_LevelNum(p) + 16; // enough to lock the tables while recomputing the deepest cone
+    if ( nSlots < nSlotsMin )
+      nSlots = nSlotsMin; // the limit is exceeded rather than failing
+    Maig_TruthStartSlots( p, nSlots );
+    if ( MemMB > 100.0 )
+      printf( "Allocated %d out of %d truth tables of %d-variable functions (%.2f MB),\n", nSlots+p->nOuts+2, nTables, p->nIns, 8.0*p->nWords*(nSlots+p->nOuts+2)/(1<<20) );  
+  }
+  else {
+    p->pTruths[0] = (word *)calloc( sizeof(word), p->nWords*p->nObjs );
+    p->pTruths[1] = (word *)calloc( sizeof(word), p->nWords*p->nObjs );
+    if ( MemMB > 100.0 )
+      printf( "Allocated %d truth tables of %d-variable functions (%.2f MB),\n", nTables, p->nIns, MemMB );  
+  }
+  p->pTruths[2] = (word *)calloc( sizeof(word), p->nWords*p->nOuts );
   p->pCare      = (word *)calloc( sizeof(word), p->nWords );
   p->pProd      = (word *)calloc( sizeof(word), p->nWords );
-  float MemMB = 8.0*p->nWords*(3*p->nObjs+2)/(1<<20);
-  if ( MemMB > 100.0 )
-    printf( "Allocated %d truth tables of %d-variable functions (%.2f MB),\n", 3*p->nObjs+2, p->nIns, MemMB );  
+  Maig_TruthStartPeriods( p );
   p->nTravIds++;
-  Maig_ForEachInput( p, i )
-    Tt_ElemInit( Maig_ObjTruth(p, i, 0), i-1, p->nWords );
-  Maig_ForEachNodeOutput( p, i )
-    Maig_TruthSimNode( p, i );
   Maig_ForEachOutput( p, i )
     assert( Maig_ObjFaninNum(p, i) == 1 );
+  if ( !p->nSlots ) { // otherwise, the tables are computed on demand
+    Maig_ForEachInput( p, i )
+      Tt_ElemInit( Maig_ObjTruth(p, i, 0), i-1, nWords );
+    Maig_TruthSim( p, NULL, 1 + p->nIns, 0, nWords );
+  }
   Maig_ForEachOutput( p, i )
-    Tt_Dup( Maig_ObjTruth(p, i, 2), Maig_ObjTruth(p, i, 0), p->nWords );
+    Tt_Dup( Maig_ObjTruthSpec(p, i), Maig_ObjTruth(p, i, 0), nWords );
 }
-static inline void Maig_TruthUpdate( maig * p, vi * vTfo )
+RW_INLINE void Maig_TruthUpdate( maig * p, vi * vTfo, int nWords )
 {
   int i, iTemp, nFails = 0;
   p->nTravIds++;
+  Maig_TruthSim( p, vTfo, 0, 0, nWords );
   Vi_ForEachEntry( vTfo, iTemp, i ) {
-    Maig_TruthSimNode( p, iTemp );
-    if ( Maig_ObjIsPo(p, iTemp) && !Tt_Equal(Maig_ObjTruth(p, iTemp, 2), Maig_ObjTruth(p, iTemp, 0), p->nWords) )
+    if ( Maig_ObjIsPo(p, iTemp) && !(p->pCareOuts ? Tt_EqualOnCare(Maig_ObjCareSpec(p, iTemp), Maig_ObjTruthSpec(p, iTemp), Maig_ObjTruth(p, iTemp, 0), nWords) : 
+                                                    Tt_Equal(Maig_ObjTruthSpec(p, iTemp), Maig_ObjTruth(p, iTemp, 0), nWords)) )
       printf( "Verification failed at output %d.\n", iTemp - (p->nObjs - p->nOuts) ), nFails++;
   }
   if ( nFails )
@@ -1178,61 +2351,77 @@ static inline vi * Maig_ComputeTfo( maig * p, int iObj )
     Maig_ComputeTfo_rec( p, i );
   return p->vTfo;
 }
-static inline word * Maig_ComputeCareSet( maig * p, int iObj )
+RW_INLINE word * Maig_ComputeCareSet( maig * p, int iObj, int nWords )
 {
-  vi * vTfo = Maig_ComputeTfo( p, iObj );  int i, iTemp;
-  Tt_Not( Maig_ObjTruth(p, iObj, 1), Maig_ObjTruth(p, iObj, 0), p->nWords );
-  Tt_Clear( p->pCare, p->nWords );
-  Vi_ForEachEntryStart( vTfo, iTemp, i, 1 ) {
-    Maig_TruthSimNode( p, iTemp );
-    if ( Maig_ObjIsPo(p, iTemp) )
-      Tt_OrXor( p->pCare, Maig_ObjTruth(p, iTemp, 0), Maig_ObjTruth(p, iTemp, 1), p->nWords );
-  }
+  vi * vTfo = Maig_ComputeTfo( p, iObj );
+  p->iCareObj = iObj;
+  word * pNeg = Maig_ObjTruthNew( p, iObj, 1 );
+  Maig_TruthLock( p, iObj, 1 );
+  Tt_Not( pNeg, Maig_ObjTruth(p, iObj, 0), nWords );
+  Maig_TruthUnlock( p, iObj, 1 );
+  Tt_Clear( p->pCare, nWords );
+  // with blocking, the TFO is re-simulated one block at a time to keep its tables in cache
+  Maig_TruthSim( p, vTfo, 1, 1, nWords );
   return p->pCare;
 }
+// returns the truth tables of the outputs (used to load external care sets)
+static inline word * Maig_ComputeOutTruths( maig * p )
+{
+  word * pRes = (word *)malloc( sizeof(word)*p->nWords*p->nOuts ); int i;
+  Maig_TruthInitialize( p, p->nWords );
+  Maig_ForEachOutput( p, i )
+    Tt_Dup( pRes + p->nWords*(i - (p->nObjs - p->nOuts)), Maig_ObjTruth(p, i, 0), p->nWords );
+  return pRes;
+}
 
 /*************************************************************
                   fanin addition/deletion 
 **************************************************************/
 
-static inline int Rw_CheckConst( maig * p, int iObj, word * pCare )
+// returns the constant literal if the node is constant on the care set (or -1 otherwise)
+RW_INLINE int Rw_FindConst( maig * p, int iObj, word * pCare, int nWords )
 {
   word * pFunc = Maig_ObjTruth(p, iObj, 0);
-  if ( !Tt_IntersectC(pCare, pFunc, 0, p->nWords) )
-  {
-    Maig_ObjDeref_rec( p, iObj, -1 );
-    Vi_Fill( p->pvFans+iObj, 1, 0 ); // const0
-    Maig_ObjRef( p, iObj );
-    Maig_TruthUpdate( p, p->vTfo );
-    if ( PRINT_DEBUG ) printf( "Detected Const0 at node %d.\n", iObj );
-    return 1;
-  }
-  if ( !Tt_IntersectC(pCare, pFunc, 1, p->nWords) )
-  {
-    Maig_ObjDeref_rec( p, iObj, -1 );
-    Vi_Fill( p->pvFans+iObj, 1, 1 ); // const1
-    Maig_ObjRef( p, iObj );
-    Maig_TruthUpdate( p, p->vTfo );
-    if ( PRINT_DEBUG ) printf( "Detected Const1 at node %d.\n", iObj );
+  if ( !Tt_IntersectC(pCare, pFunc, 0, nWords) )
+    return 0;
+  if ( !Tt_IntersectC(pCare, pFunc, 1, nWords) )
     return 1;
-  }
-  return 0;
+  return -1;
+}
+static inline void Rw_SetConst( maig * p, int iObj, int iLit )
+{
+  Maig_ObjDeref_rec( p, iObj, -1 );
+  Maig_ObjSetKind( p, iObj, MAIG_AND );
+  Vi_Fill( p->pvFans+iObj, 1, iLit );
+  Maig_ObjRef( p, iObj );
+  if ( PRINT_DEBUG ) printf( "Detected Const%d at node %d.\n", iLit, iObj );
+}
+RW_INLINE int Rw_CheckConst( maig * p, int iObj, word * pCare, int nWords )
+{
+  int iLit = Rw_FindConst( p, iObj, pCare, nWords );
+  if ( iLit == -1 )
+    return 0;
+  Rw_SetConst( p, iObj, iLit );
+  Maig_TruthUpdate( p, p->vTfo, nWords );
+  return 1;
 }
-static inline int Rw_ExpandOne( maig * p, int iObj, int nAddedMax )
+// finds up to nAddedMax fanins that can be added to the node without changing its function 
+// on the care set; the network is not changed (the fanins are returned in vFound)
+RW_INLINE int Rw_ExpandFind( maig * p, int iObj, int nAddedMax, vi * vFound, int nWords )
 {
   //printf( "e%d ", iObj ); fflush(stdout);
   int i, k, n, iLit, nFans = Maig_ObjFaninNum(p, iObj), nAdded = 0;
-  word * pCare = Maig_ComputeCareSet( p, iObj );
-//  if ( Rw_CheckConst(p, iObj, pCare) )
+  word * pCare = Maig_ComputeCareSet( p, iObj, nWords );
+//  if ( Rw_CheckConst(p, iObj, pCare, nWords) )
 //    return 0;
   assert( nAddedMax > 0 );
   assert( nAddedMax <= Vi_Space(p->pvFans+iObj) );
   // mark node's fanins
   Maig_ForEachObjFanin( p, iObj, iLit, k )
     p->pTravIds[Lit2Var(iLit)] = p->nTravIds;
-  // compute the onset
-  word * pOnset = Maig_ObjTruth( p, iObj, 0 );
-  Tt_Sharp( pOnset, pCare, 0, p->nWords );
+  // compute the onset (restricted to the care set)
+  word * pOnset = pCare;
+  Tt_Sharp( pOnset, Maig_ObjTruth(p, iObj, 0), 0, nWords );
   // create a random order of fanin candidates 
   if ( 1 ) {
     Vi_Shrink( p->vOrderF, 0 );
@@ -1240,7 +2429,7 @@ static inline int Rw_ExpandOne( maig * p, int iObj, int nAddedMax )
       if ( p->pTravIds[i] != p->nTravIds && (Maig_ObjIsPi(p, i) || (Maig_ObjFaninNum(p, i) > 1 && p->pRefs[i] > 0)) ) // this node is NOT in the TFO
 //      if ( p->pTravIds[i] != p->nTravIds ) // this node is NOT in the TFO
         Vi_Push( p->vOrderF, i );
-    Vi_Randomize(p->vOrderF);
+    Vi_Randomize(p->vOrderF, p->pRng);
   }
   else {
     // put high-fanout references first
@@ -1248,7 +2437,7 @@ static inline int Rw_ExpandOne( maig * p, int iObj, int nAddedMax )
     Maig_ForEachNode( p, i )
       if ( p->pTravIds[i] != p->nTravIds && p->pRefs[i] > 1 ) // this node is NOT in the TFO
         Vi_Push( p->vOrderF, i );
-    Vi_Randomize(p->vOrderF);
+    Vi_Randomize(p->vOrderF, p->pRng);
     // put primary inputs and low-fanout references second
     Vi_Shrink( p->vOrderF2, 0 );
     Maig_ForEachInput( p, i )
@@ -1257,7 +2446,7 @@ static inline int Rw_ExpandOne( maig * p, int iObj, int nAddedMax )
     Maig_ForEachNode( p, i )
       if ( p->pTravIds[i] != p->nTravIds && p->pRefs[i] == 1 ) // this node is NOT in the TFO
         Vi_Push( p->vOrderF2, i );
-    Vi_Randomize(p->vOrderF2);
+    Vi_Randomize(p->vOrderF2, p->pRng);
     Vi_PushArray(p->vOrderF, Vi_Array(p->vOrderF2), Vi_Size(p->vOrderF2));
   }
 
@@ -1267,18 +2456,34 @@ static inline int Rw_ExpandOne( maig * p, int iObj, int nAddedMax )
     assert( p->pTravIds[i] != p->nTravIds );
     // new fanin can be added if its offset does not intersect with the node's onset
     for ( n = 0; n < 2; n++ )
-    if ( !Tt_IntersectC(pOnset, Maig_ObjTruth(p, i, 0), !n, p->nWords) ) {
-        if ( PRINT_DEBUG ) printf( "Adding node %d fanin %d\n", iObj, Var2Lit(i, n) );
-        Maig_AppendFanin(p, iObj, Var2Lit(i, n));
-        p->pRefs[i]++;
+    if ( !Tt_IntersectC(pOnset, Maig_ObjTruth(p, i, 0), !n, nWords) ) {
+        Vi_Push( vFound, Var2Lit(i, n) );
         nAdded++;
         break;
     }
     if ( nAdded == nAddedMax )
       break;
   }
+  return nAdded;
+}
+// adds the first nAdded fanins found for the node (the TFO is updated by the caller)
+static inline int Rw_ExpandAdd( maig * p, int iObj, vi * vFound, int nAdded )
+{
+  int k, iLit;
+  Vi_ForEachEntryStop( vFound, iLit, k, nAdded ) {
+    if ( PRINT_DEBUG ) printf( "Adding node %d fanin %d\n", iObj, iLit );
+    Maig_AppendFanin( p, iObj, iLit );
+    p->pRefs[Lit2Var(iLit)]++;
+  }
+  return nAdded;
+}
+RW_INLINE int Rw_ExpandOne( maig * p, int iObj, int nAddedMax, int nWords )
+{
+  int nAdded;
+  Vi_Shrink( p->vFound, 0 );
+  nAdded = Rw_ExpandAdd( p, iObj, p->vFound, Rw_ExpandFind(p, iObj, nAddedMax, p->vFound, nWords) );
   //printf( "Updating TFO of node %d:  ", iObj );  Vi_Print(p->vTfo);
-  Maig_TruthUpdate( p, p->vTfo );
+  Maig_TruthUpdate( p, p->vTfo, nWords );
   //assert( Maig_ObjFaninNum(p, iObj) <= nFaninMax );
   return nAdded;
 }
@@ -1296,62 +2501,87 @@ static inline int Rw_ReduceFanins( maig * p, int i, int m )
   assert( Counter == Tt_BitCount16(m) );
   return nFans - Counter;
 }
-static inline int Rw_ReduceOne( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer )
+RW_INLINE int Rw_ReduceOne( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer, int nWords )
 {
   //printf( "r%d ", iObj ); fflush(stdout);
   int i, n, nFans = Maig_ObjFaninNum(p, iObj), m, nMints = 1 << nFans;
-  word * pCare = Maig_ComputeCareSet( p, iObj );
-  if ( Rw_CheckConst(p, iObj, pCare) )
+  word * pCare = Maig_ComputeCareSet( p, iObj, nWords );
+  if ( Rw_CheckConst(p, iObj, pCare, nWords) )
     return nFans;
-  if ( fOnlyConst )
+  if ( fOnlyConst || !Maig_ObjIsAnd(p, iObj) )
     return 0;    
   // find a minimum fanin subset whose function is equal to the function of the node on the care set
   word * pFunc = Maig_ObjTruth( p, iObj, 0 ), * pProd;  
+  Maig_TruthLock( p, iObj, 0 );
   for ( n = 1; n < nFans; n++ )
   for ( m = 1; m < nMints-1; m++ )
     if ( Tt_BitCount16(m) == n ) {
-      pProd = Maig_TruthSimNodeSubset( p, iObj, m );
-      if ( Tt_EqualOnCare(pCare, pFunc, pProd, p->nWords) ) {
+      pProd = Maig_TruthSimNodeSubset( p, iObj, m, nWords );
+      if ( Tt_EqualOnCare(pCare, pFunc, pProd, nWords) ) {
         Maig_ObjDeref( p, iObj );
         int Value = Rw_ReduceFanins(p, iObj, m);;
         Maig_ObjRef( p, iObj );
-        Maig_TruthUpdate( p, p->vTfo );
+        Maig_TruthUpdate( p, p->vTfo, nWords );
+        Maig_TruthUnlock( p, iObj, 0 );
         if ( PRINT_DEBUG ) printf( "Reducing node %d fanin count from %d to %d.\n", iObj, nFans, Maig_ObjFaninNum(p, iObj) );
         return Value;
       }
     }
-  pProd = Maig_TruthSimNodeSubset( p, iObj, nMints-1 );
-  assert( Tt_EqualOnCare(pCare, pFunc, pProd, p->nWords) );
+  pProd = Maig_TruthSimNodeSubset( p, iObj, nMints-1, nWords );
+  assert( Tt_EqualOnCare(pCare, pFunc, pProd, nWords) );
+  Maig_TruthUnlock( p, iObj, 0 );
   return 0;
 }
 
-// this procedure tries to prioritize fanins during reduction
-static inline int Rw_ReduceOne2( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer )
+// the results of the reduction
+#define RW_REDUCE_NONE   0  // the node cannot be reduced
+#define RW_REDUCE_CONST  1  // the node is constant
+#define RW_REDUCE_FANINS 2  // the node has fewer fanins
+
+// this procedure tries to prioritize fanins during reduction; it finds the constant 
+// or the smaller fanin set of the node (returned in vFound) without changing the network
+RW_INLINE int Rw_ReduceFind( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer, vi * vFound, int nWords )
 {
   //printf( "r%d ", iObj ); fflush(stdout);
   int i, n, k, iLit, nFans = Maig_ObjFaninNum(p, iObj);
-  word * pCare = Maig_ComputeCareSet( p, iObj );
-  if ( Rw_CheckConst(p, iObj, pCare) )
-    return nFans;
+  word * pCare = Maig_ComputeCareSet( p, iObj, nWords );
+  Vi_Shrink( vFound, 0 );
+  if ( (iLit = Rw_FindConst(p, iObj, pCare, nWords)) >= 0 ) {
+    Vi_Push( vFound, iLit );
+    return RW_REDUCE_CONST;
+  }
   if ( fOnlyConst )
-    return 0;
+    return RW_REDUCE_NONE;
   if ( nFans == 1 )
-    return 0;
+    return RW_REDUCE_NONE;
   // if one fanin can be used, take it
   word * pFunc = Maig_ObjTruth( p, iObj, 0 );
+  Maig_TruthLock( p, iObj, 0 );
+  if ( !Maig_ObjIsAnd(p, iObj) ) { // a XOR/MUX node can only become a buffer of a fanin in either polarity
+    Maig_ForEachObjFanin( p, iObj, iLit, k )
+      for ( n = 0; n < 2; n++ ) {
+        Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit) ^ n, nWords );
+        if ( Tt_EqualOnCare(pCare, pFunc, p->pProd, nWords) ) {
+          Maig_TruthUnlock( p, iObj, 0 );
+          Vi_Push( vFound, LitNotC(iLit, n) );
+          return RW_REDUCE_FANINS;
+        }
+      }
+    Maig_TruthUnlock( p, iObj, 0 );
+    return RW_REDUCE_NONE;
+  }
   Maig_ForEachObjFanin( p, iObj, iLit, k ) { 
-    Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), p->nWords );
-    if ( Tt_EqualOnCare(pCare, pFunc, p->pProd, p->nWords) ) {
-      Maig_ObjDeref( p, iObj );
-      Vi_Fill( p->pvFans+iObj, 1, iLit );
-      Maig_ObjRef( p, iObj );
-      Maig_TruthUpdate( p, p->vTfo );
-      if ( PRINT_DEBUG ) printf( "Reducing node %d fanin count from %d to %d.\n", iObj, nFans, Maig_ObjFaninNum(p, iObj) );
-      return nFans-1;      
+    Tt_DupC( p->pProd, Maig_ObjTruth(p, Lit2Var(iLit), 0), Lit2C(iLit), nWords );
+    if ( Tt_EqualOnCare(pCare, pFunc, p->pProd, nWords) ) {
+      Maig_TruthUnlock( p, iObj, 0 );
+      Vi_Push( vFound, iLit );
+      return RW_REDUCE_FANINS;
     }
   }
-  if ( fOnlyBuffer )
-    return 0;
+  if ( fOnlyBuffer ) {
+    Maig_TruthUnlock( p, iObj, 0 );
+    return RW_REDUCE_NONE;
+  }
   // create order of fanins with high reference fanins first
   Vi_Shrink( p->vOrderF, 0 );
   Maig_ForEachObjFanin( p, iObj, iLit, k )
@@ -1367,218 +2597,3044 @@ static inline int Rw_ReduceOne2( maig * p, int iObj, int fOnlyConst, int fOnlyBu
   // try to remove fanins starting from the end of the list
   for ( n = Vi_Size(p->vOrderF)-1; n >= 0; n-- ) {
     int iFanin = Vi_Drop(p->vOrderF, n);
-    word * pProd = Maig_TruthSimNodeSubset2( p, iObj, p->vOrderF, Vi_Size(p->vOrderF) );
-    if ( !Tt_EqualOnCare(pCare, pFunc, pProd, p->nWords) )
+    word * pProd = Maig_TruthSimNodeSubset2( p, iObj, p->vOrderF, Vi_Size(p->vOrderF), nWords );
+    if ( !Tt_EqualOnCare(pCare, pFunc, pProd, nWords) )
       Vi_Push(p->vOrderF, iFanin);
   }
   assert( Vi_Size(p->vOrderF) >= 1 );
-  // update the node if it is reduced
-  if ( Vi_Size(p->vOrderF) < nFans ) {
-    Maig_ObjDeref(p, iObj);
-    Vi_Shrink( p->pvFans+iObj, 0 );
-    Vi_ForEachEntry( p->vOrderF, iLit, k )
-      Vi_PushOrder( p->pvFans+iObj, iLit );
-    Maig_ObjRef(p, iObj);
-    Maig_TruthUpdate( p, p->vTfo );
-    if ( PRINT_DEBUG ) printf( "Reducing node %d fanin count from %d to %d.\n", iObj, nFans, Maig_ObjFaninNum(p, iObj) );
-    return nFans-Vi_Size(p->vOrderF);
+  Maig_TruthUnlock( p, iObj, 0 );
+  if ( Vi_Size(p->vOrderF) == nFans )
+    return RW_REDUCE_NONE;
+  Vi_ForEachEntry( p->vOrderF, iLit, k )
+    Vi_PushOrder( vFound, iLit );
+  return RW_REDUCE_FANINS;
+}
+// changes the node as found by Rw_ReduceFind (the TFO is updated by the caller); returns the number of removed fanins
+static inline int Rw_ReduceApply( maig * p, int iObj, int Status, vi * vFound )
+{
+  int k, iLit, nFans = Maig_ObjFaninNum(p, iObj);
+  if ( Status == RW_REDUCE_CONST ) {
+    Rw_SetConst( p, iObj, Vi_Read(vFound, 0) );
+    return nFans;
   }
-  return 0;
+  assert( Status == RW_REDUCE_FANINS && Vi_Size(vFound) < nFans );
+  Maig_ObjDeref(p, iObj);
+  Maig_ObjSetKind( p, iObj, MAIG_AND );
+  Vi_Shrink( p->pvFans+iObj, 0 );
+  Vi_ForEachEntry( vFound, iLit, k )
+    Vi_Push( p->pvFans+iObj, iLit );
+  Maig_ObjRef(p, iObj);
+  if ( PRINT_DEBUG ) printf( "Reducing node %d fanin count from %d to %d.\n", iObj, nFans, Maig_ObjFaninNum(p, iObj) );
+  return nFans-Vi_Size(vFound);
+}
+RW_INLINE int Rw_ReduceOne2( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer, int nWords )
+{
+  int Value, Status = Rw_ReduceFind( p, iObj, fOnlyConst, fOnlyBuffer, p->vFound, nWords );
+  if ( Status == RW_REDUCE_NONE )
+    return 0;
+  Value = Rw_ReduceApply( p, iObj, Status, p->vFound );
+  Maig_TruthUpdate( p, p->vTfo, nWords );
+  return Value;
 }
 
 /*************************************************************
-                  high-level rewiring code
+                     resubstitution
 **************************************************************/
 
-static inline vi * Rw_CreateOrder( maig * p )
+#define RW_RESUB_DIVS 200  // the limit on the number of unate literals combined in pairs
+
+// the signature is the value of the function in 64 fixed minterms (the first word for small functions)
+static inline word Maig_TruthSign( maig * p, word * pTruth )
 {
-  int i;
-  Vi_Shrink( p->vOrder, 0 );
-  Maig_ForEachNode( p, i )
-    Vi_Push( p->vOrder, i );
-  Vi_Randomize( p->vOrder );
-  return p->vOrder;
+  word Sign = 0; int k;
+  if ( p->nWords == 1 )
+    return pTruth[0];
+  for ( k = 0; k < 64; k++ )
+    if ( Tt_GetBit(pTruth, (int)(((word)(k+1) * 0x9E3779B97F4A7C15) >> (64 - p->nIns))) )
+      Sign |= (word)1 << k;
+  return Sign;
 }
-static inline maig * Rw_Expand( maig * p, int nFaninAddLimitAll )
+static inline void Maig_ObjSignUpdate( maig * p, int i ) { p->pSigns[i] = Maig_TruthSign( p, Maig_ObjTruth(p, i, 0) );                    }
+static inline word Maig_LitSign( maig * p, int iLit )    { return Lit2C(iLit) ? ~p->pSigns[Lit2Var(iLit)] : p->pSigns[Lit2Var(iLit)]; }
+static inline void Maig_TruthSignStart( maig * p )
 {
-  int i, iNode, nAdded = 0;
-  assert( nFaninAddLimitAll > 0 );
-  vi * vOrder = Rw_CreateOrder( p );
-  //printf( "Random order:  " ); Vi_Print( p->vOrder );
-  Maig_TruthInitialize(p);
-  Maig_InitializeRefs(p);
-  Vi_ForEachEntry( vOrder, iNode, i )
-    if ( (nAdded += Rw_ExpandOne(p, iNode, MinInt(Vi_Space(p->pvFans+iNode), nFaninAddLimitAll-nAdded))) >= nFaninAddLimitAll )
-      break;
-  assert( nAdded <= nFaninAddLimitAll );
-  Maig_VerifyRefs(p);    
-  return Maig_DupDfs(p);  
+  int i;
+  if ( p->pSigns == NULL )
+    p->pSigns = (word *)calloc( sizeof(word), p->nObjsAlloc );
+  Maig_ForEachObj( p, i )
+    Maig_ObjSignUpdate( p, i );
 }
-static inline maig * Rw_Reduce( maig * p )
+static inline void Maig_TruthSignUpdate( maig * p, vi * vTfo )
 {
-  int i, iNode;
-  vi * vOrder = Rw_CreateOrder( p );
-  //printf( "Random order:  " ); Vi_Print( p->vOrder );
-  Maig_TruthInitialize(p);
-  Maig_InitializeRefs(p);
-/*  
-  int Value = Random_Num(0) % 16;
-  if ( Value == 0 )
-    Maig_ForEachNodeReverse( p, iNode )
-      Rw_ReduceOne( p, iNode, 0, 0 );
-  else if ( Value == 1 )
-    Maig_ForEachNodeReverse( p, iNode )
-      Rw_ReduceOne2( p, iNode, 0, 0 );      
-  else if ( Value == 2 )
-    Maig_ForEachNode( p, iNode )
-      Rw_ReduceOne( p, iNode, 0, 0 );
-  else if ( Value == 3 )
-    Maig_ForEachNode( p, iNode )
-      Rw_ReduceOne2( p, iNode, 0, 0 );      
-  else if ( Value == 4 )
-    Vi_ForEachEntry( vOrder, iNode, i )
-      Rw_ReduceOne( p, iNode, 0, 0 );
-  else 
-    Vi_ForEachEntry( vOrder, iNode, i )
-      Rw_ReduceOne2( p, iNode, 0, 0 );
-*/
-  // works best for final
-  Vi_ForEachEntry( vOrder, iNode, i )
-    Rw_ReduceOne2( p, iNode, 0, 0 );
-  Maig_VerifyRefs(p);
-  return Maig_DupStrash(p, 1, 1);
+  int i, iTemp;
+  Vi_ForEachEntry( vTfo, iTemp, i )
+    Maig_ObjSignUpdate( p, iTemp );
 }
 
-
-// storage for best AIGs
-#define SAVE_NUM 8
-
-int Rw_AddBest( maig ** pBests, int nBests, maig * pNew )
-{
-    if ( nBests < SAVE_NUM )
-        pBests[nBests++] = pNew;
-    else {
-        assert( nBests == SAVE_NUM );
-        int iNum = Random_Num(0) % SAVE_NUM;
-        Maig_Free( pBests[iNum] );
-        pBests[iNum] = pNew;
-    }
-    return nBests;
-}
-maig * Rw_ReadBest( maig ** pBests, int nBests )
+// returns the number of AND2 gates saved by making the node an AND of one or two literals
+static inline int Rw_ResubGain( maig * p, int iObj, int iLit0, int iLit1 )
 {
-    return pBests[Random_Num(0) % nBests];
+  int Gain;
+  p->pRefs[Lit2Var(iLit0)]++;
+  if ( iLit1 >= 0 ) p->pRefs[Lit2Var(iLit1)]++;
+  Gain = Maig_ObjDerefCount_rec( p, iObj ) - (int)(iLit1 >= 0);
+  Maig_ObjRef_rec( p, iObj );
+  p->pRefs[Lit2Var(iLit0)]--;
+  if ( iLit1 >= 0 ) p->pRefs[Lit2Var(iLit1)]--;
+  return Gain;
 }
-void Rw_CleanBest( maig ** pBests, int nBests )
+// replaces the fanins of the node by one or two literals (complemented nodes express OR as AND)
+static inline void Rw_ResubUpdate( maig * p, int iObj, int iLit0, int iLit1, int fCompl, int nWords )
 {
-    for ( int i = 0; i < nBests; i++ )
-        Maig_Free( pBests[i] );
+  int i, k, iLit, iFan, fChange;
+  p->pRefs[Lit2Var(iLit0)]++;
+  if ( iLit1 >= 0 ) p->pRefs[Lit2Var(iLit1)]++;
+  Maig_ObjDeref_rec( p, iObj, -1 );
+  Maig_ObjSetKind( p, iObj, MAIG_AND );
+  Vi_Fill( p->pvFans+iObj, 1, LitNotC(iLit0, fCompl) );
+  if ( iLit1 >= 0 )
+    Maig_AppendFanin( p, iObj, LitNotC(iLit1, fCompl) );
+  if ( fCompl ) // the fanouts (all of them are in the TFO computed for the care set) now use the complemented node
+    Vi_ForEachEntryStart( p->vTfo, iFan, i, 1 ) {
+      fChange = 0;
+      Maig_ForEachObjFanin( p, iFan, iLit, k )
+        if ( Lit2Var(iLit) == iObj )
+          Vi_Write( p->pvFans+iFan, k, LitNot(iLit) ), fChange = 1;
+      if ( fChange && !Maig_ObjIsMux(p, iFan) ) // the fanins of MUX keep their order
+        Vi_SelectSort( p->pvFans+iFan );
+    }
+  Maig_TruthUpdate( p, p->vTfo, nWords );
+  Maig_TruthSignUpdate( p, p->vTfo );
 }
-
-static inline maig * Rw_PerformRewire( maig * p, int nIters, int nExpands, int nGrowth, int nDivs, int nFaninMax, int nTimeOut, int fVerbose )
+// tries to express the node on its care set using one divisor or an AND/OR of two divisors
+RW_INLINE int Rw_ResubOne( maig * p, int iObj, int nLevel, int nWords )
 {
-  maig * pBests[SAVE_NUM] = {NULL}; int nBests = 1;
-  int i, k, n, iNode;
-  iword clkTotal = Time_Clock(); 
-  iword clk, times[3] = {0};
-  maig * pTemp, * pNew; 
-  maig * pBest = pBests[0] = Maig_Dup( p, 0 );
-  int PrevBest = Maig_CountAnd2(pBest);
-  int nAnd2, nAdded, nShared, nRemoved;
-  for ( i = 0; i < nIters; i++ )
-  {
-    // expand
-    clk      = Time_Clock(); 
-    pNew     = Maig_DupMulti(pBest, nFaninMax, nGrowth);     
-    nAnd2    = Maig_CountAnd2(pNew);
-    pNew     = Rw_Expand(pTemp = pNew, nExpands); Maig_Free( pTemp );
-    nAdded   = Maig_CountAnd2(pNew) - nAnd2;
-    times[0]+= Time_Clock() - clk;
-    // share
-    clk      = Time_Clock(); 
-    nAnd2    = Maig_CountAnd2(pNew);  
-    pNew     = Rw_Share( pTemp = pNew, nDivs ); Maig_Free( pTemp );
-    nShared  = nAnd2 - Maig_CountAnd2(pNew);
-    times[1]+= Time_Clock() - clk;
-    // reduce
-    clk      = Time_Clock(); 
-    nAnd2    = Maig_CountAnd2(pNew);  
-    pNew     = Rw_Reduce( pTemp = pNew );   Maig_Free( pTemp );
-    nRemoved = nAnd2 - Maig_CountAnd2(pNew);
-    times[2]+= Time_Clock() - clk;
-    // compare
-    if ( 0 ) 
-    {
-      if ( Maig_CountAnd2(pBest) >= Maig_CountAnd2(pNew) )
-        RW_SWAP( maig *, pBest, pNew )
-      Maig_Free( pNew );
+  int i, k, j, n, iLit, iLit0, iLit1, Gain;
+  int nMffc = Maig_ObjDerefCount_rec( p, iObj );
+  Maig_ObjRef_rec( p, iObj );
+  word * pCare = Maig_ComputeCareSet( p, iObj, nWords );
+  if ( Rw_CheckConst(p, iObj, pCare, nWords) ) {
+    Maig_TruthSignUpdate( p, p->vTfo );
+    return nMffc;
+  }
+  if ( nMffc == 0 )
+    return 0;
+  word * pFunc = Maig_ObjTruth( p, iObj, 0 ), * pTemp;
+  word Sign = p->pSigns[iObj], SignD, Mask = Maig_TruthSign( p, pCare );
+  Maig_TruthLock( p, iObj, 0 );
+  // try single divisors while collecting the literals that can be combined in pairs
+  Vi_Shrink( p->vOrderF, 0 );  // literals containing the onset (AND of two literals)
+  Vi_Shrink( p->vOrderF2, 0 ); // literals contained in the onset (OR of two literals)
+  Maig_ForEachInputNode( p, i ) {
+    if ( p->pTravIds[i] == p->nTravIds || !(Maig_ObjIsPi(p, i) || (Maig_ObjFaninNum(p, i) > 1 && p->pRefs[i] > 0)) )
+      continue;
+    for ( n = 0; n < 2; n++ ) {
+      iLit = Var2Lit(i, n);
+      SignD = Maig_LitSign( p, iLit );
+      if ( ((SignD ^ Sign) & Mask) == 0 ) {
+        Tt_DupC( p->pProd, Maig_ObjTruth(p, i, 0), n, nWords );
+        if ( Tt_EqualOnCare(pCare, pFunc, p->pProd, nWords) && (Gain = Rw_ResubGain(p, iObj, iLit, -1)) > 0 ) {
+          if ( PRINT_DEBUG ) printf( "Resubstituting node %d by literal %d.\n", iObj, iLit );
+          Rw_ResubUpdate( p, iObj, iLit, -1, 0, nWords );
+          Maig_TruthUnlock( p, iObj, 0 );
+          return Gain;
+        }
+      }
+      if ( nLevel < 2 || nMffc < 2 )
+        continue;
+      if ( (Sign & ~SignD & Mask) == 0 && Vi_Size(p->vOrderF) < RW_RESUB_DIVS && !Tt_IntersectC2(pCare, pFunc, 0, Maig_ObjTruth(p, i, 0), !n, nWords) )
+        Vi_Push( p->vOrderF, iLit );
+      if ( (~Sign & SignD & Mask) == 0 && Vi_Size(p->vOrderF2) < RW_RESUB_DIVS && !Tt_IntersectC2(pCare, pFunc, 1, Maig_ObjTruth(p, i, 0), n, nWords) )
+        Vi_Push( p->vOrderF2, iLit );
     }
-    else 
-    {
-      if ( Maig_CountAnd2(pBest) < Maig_CountAnd2(pNew) )
-        Maig_Free(pNew);
-      else if ( Maig_CountAnd2(pBest) == Maig_CountAnd2(pNew) )
-        nBests = Rw_AddBest(pBests, nBests, pNew);
-      else {
-        Rw_CleanBest(pBests, nBests);
-        pBests[0] = pNew;
-        nBests = 1;
+  }
+  // try pairs of literals: the product should not intersect the offset or the sum should cover the onset
+  for ( n = 0; n < 2; n++ ) {
+    vi * vLits = n ? p->vOrderF2 : p->vOrderF;
+    Vi_ForEachEntry( vLits, iLit0, k ) {
+      word Sign0 = Maig_LitSign( p, iLit0 );
+      pTemp = Maig_ObjTruth( p, Lit2Var(iLit0), 0 );
+      Maig_TruthLock( p, Lit2Var(iLit0), 0 );
+      Vi_ForEachEntryStart( vLits, iLit1, j, k+1 ) {
+        word Sign1 = Maig_LitSign( p, iLit1 );
+        if ( Lit2Var(iLit0) == Lit2Var(iLit1) || (((n ? Sign0 | Sign1 : Sign0 & Sign1) ^ Sign) & Mask) )
+          continue;
+        if ( Tt_IntersectC3(pCare, pFunc, !n, pTemp, Lit2C(iLit0) ^ n, Maig_ObjTruth(p, Lit2Var(iLit1), 0), Lit2C(iLit1) ^ n, nWords) )
+          continue;
+        if ( (Gain = Rw_ResubGain(p, iObj, iLit0, iLit1)) <= 0 )
+          continue;
+        if ( PRINT_DEBUG ) printf( "Resubstituting node %d by %s of literals %d and %d.\n", iObj, n ? "OR" : "AND", iLit0, iLit1 );
+        Maig_TruthUnlock( p, Lit2Var(iLit0), 0 );
+        Rw_ResubUpdate( p, iObj, iLit0, iLit1, n, nWords );
+        Maig_TruthUnlock( p, iObj, 0 );
+        return Gain;
       }
-      pBest = Rw_ReadBest(pBests, nBests);
+      Maig_TruthUnlock( p, Lit2Var(iLit0), 0 );
     }
-    // report
-    if ( PrevBest > Maig_CountAnd2(pBest) )
-    {
-        printf( "Iteration %5d :  ", i );
-        printf( "Added =%4d  ",     nAdded );
-        printf( "Shared =%4d  ",    nShared );
-        printf( "Removed =%4d  ",   nRemoved );
-        printf( "Best =%5d",        Maig_CountAnd2(pBest) );
-        printf( "\n" );
-        PrevBest = Maig_CountAnd2(pBest);
-    }    
   }
-  pBest = Maig_Dup( pBest, 0 );
-  Rw_CleanBest( pBests, nBests );
-  Time_Print( "Total solving time", Time_Clock() - clkTotal );
-  printf( "  (" );
-  printf( "Expand = %.1f %%  ", 100.0*times[0]/(Time_Clock() - clkTotal) );
-  printf( "Share = %.1f %%  ",  100.0*times[1]/(Time_Clock() - clkTotal) );
-  printf( "Reduce = %.1f %%",   100.0*times[2]/(Time_Clock() - clkTotal) );
-  printf( ")\n" );
-  return pBest;
+  Maig_TruthUnlock( p, iObj, 0 );
+  return 0;
 }
 
-Mini_Aig_t * Rw_Transform( Mini_Aig_t * pAig, int nIters, int nExpands, int nGrowth, int nDivs, int nFaninMax, int nTimeOut, int fVerbose )
+/*************************************************************
+            engines specialized for the truth table size
+**************************************************************/
+
+// the engine bundles the simulation/care-set/expand/reduce/resub code instantiated for a fixed 
+// number of words, which lets the compiler unroll the Tt_* loops and keep tables in registers
+typedef struct rw_engine_ {
+  int     nWords;       // the truth table size (0 = any)
+  void (* pFuncInit)  ( maig * p );
+  void (* pFuncUpdate)( maig * p, vi * vTfo );
+  int  (* pFuncExpand)( maig * p, int iObj, int nAddedMax );
+  int  (* pFuncExpandFind)( maig * p, int iObj, int nAddedMax, vi * vFound );
+  int  (* pFuncReduce)( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer );
+  int  (* pFuncReduceFind)( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer, vi * vFound );
+  int  (* pFuncResub) ( maig * p, int iObj, int nLevel );
+} rw_engine;
+
+#define RW_ENGINE_DEFINE( Name, nW )                                                                                               \
+static void Rw_TruthInitW##Name( maig * p )                                            { Maig_TruthInitialize( p, nW );                        } \
+static void Rw_TruthUpdateW##Name( maig * p, vi * vTfo )                               { Maig_TruthUpdate( p, vTfo, nW );                      } \
+static int  Rw_ExpandOneW##Name( maig * p, int iObj, int nAddedMax )                   { return Rw_ExpandOne( p, iObj, nAddedMax, nW );        } \
+static int  Rw_ExpandFindW##Name( maig * p, int iObj, int nAddedMax, vi * vFound )     { return Rw_ExpandFind( p, iObj, nAddedMax, vFound, nW ); } \
+static int  Rw_ReduceOneW##Name( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer ) { return Rw_ReduceOne2( p, iObj, fOnlyConst, fOnlyBuffer, nW ); } \
+static int  Rw_ReduceFindW##Name( maig * p, int iObj, int fOnlyConst, int fOnlyBuffer, vi * vFound ) { return Rw_ReduceFind( p, iObj, fOnlyConst, fOnlyBuffer, vFound, nW ); } \
+static int  Rw_ResubOneW##Name( maig * p, int iObj, int nLevel )                       { return Rw_ResubOne( p, iObj, nLevel, nW );            }
+
+RW_ENGINE_DEFINE( 1,   1 )
+RW_ENGINE_DEFINE( 2,   2 )
+RW_ENGINE_DEFINE( 4,   4 )
+RW_ENGINE_DEFINE( 8,   8 )
+RW_ENGINE_DEFINE( 16,  16 )
+RW_ENGINE_DEFINE( Any, p->nWords )
+
+static rw_engine s_Engines[6] = {
+  { 1,  Rw_TruthInitW1,   Rw_TruthUpdateW1,   Rw_ExpandOneW1,   Rw_ExpandFindW1,   Rw_ReduceOneW1,   Rw_ReduceFindW1,   Rw_ResubOneW1   },  // up to 6 inputs
+  { 2,  Rw_TruthInitW2,   Rw_TruthUpdateW2,   Rw_ExpandOneW2,   Rw_ExpandFindW2,   Rw_ReduceOneW2,   Rw_ReduceFindW2,   Rw_ResubOneW2   },  // 7 inputs
+  { 4,  Rw_TruthInitW4,   Rw_TruthUpdateW4,   Rw_ExpandOneW4,   Rw_ExpandFindW4,   Rw_ReduceOneW4,   Rw_ReduceFindW4,   Rw_ResubOneW4   },  // 8 inputs
+  { 8,  Rw_TruthInitW8,   Rw_TruthUpdateW8,   Rw_ExpandOneW8,   Rw_ExpandFindW8,   Rw_ReduceOneW8,   Rw_ReduceFindW8,   Rw_ResubOneW8   },  // 9 inputs
+  { 16, Rw_TruthInitW16,  Rw_TruthUpdateW16,  Rw_ExpandOneW16,  Rw_ExpandFindW16,  Rw_ReduceOneW16,  Rw_ReduceFindW16,  Rw_ResubOneW16  },  // 10 inputs
+  { 0,  Rw_TruthInitWAny, Rw_TruthUpdateWAny, Rw_ExpandOneWAny, Rw_ExpandFindWAny, Rw_ReduceOneWAny, Rw_ReduceFindWAny, Rw_ResubOneWAny }   // any size
+};
+
+// selects the engine based on the number of primary inputs
+static inline rw_engine * Rw_EngineSelect( maig * p )
 {
-  if ( 1 )
-  {
-    maig * p = Maig_FromMiniAig( pAig );
-    maig * pNew = Rw_PerformRewire( p, nIters, nExpands, nGrowth, nDivs, nFaninMax, nTimeOut, fVerbose );
-    pAig = Maig_ToMiniAig( pNew );
-    Maig_Free( pNew );
-    Maig_Free( p );
-  }
-  else
-  {
-    maig * p = Maig_FromMiniAig( pAig );                  // Maig_Print( p );
-    maig * pNew1 = Maig_DupMulti(p, nFaninMax, nGrowth);  // Maig_Print( pNew1 );
-    maig * pNew2 = Rw_Expand(pNew1, nExpands);            // Maig_Print( pNew2 );
-    maig * pNew3 = Rw_Reduce(pNew2);                      // Maig_Print( pNew3 );
-    pAig = Maig_ToMiniAig( pNew3 );
-    Maig_Free( pNew2 );
-    Maig_Free( pNew1 );
-    Maig_Free( p );
-  }
-  return pAig;
+  int i;
+  for ( i = 0; s_Engines[i].nWords; i++ )
+    if ( s_Engines[i].nWords == p->nWords )
+      break;
+  return s_Engines + i;
 }
 
 /*************************************************************
-                    main() procedure
+              exact synthesis of 4-input cuts
 **************************************************************/
 
-void Rw_OutputFilename( char * pIn, char * pOut )
-{
+// The library keeps the smallest known AIG for each NPN class of 4-input functions.
+// It is built at startup by combining the structures of two classes (one of them under 
+// an input permutation/negation) in the order of their size, while the nodes with equal 
+// functions are shared.  The stage replaces the cone of a node above its 4-input cut
+// by the structure of the cut function when the structure is smaller than the MFFC.
+
+#define RW_EX_NODES   13     // the largest structure in the library
+#define RW_EX_CUTS     8     // the number of cuts stored at a node
+#define RW_EX_PERMS   24     // the number of input permutations
+#define RW_EX_TRANS  384     // the number of input permutations and negations
+#define RW_EX_ALTS     2     // the number of structures of the same size kept for a class while building
+
+typedef unsigned short tt16;
+
+// a structure has the constant (0), the inputs (1-4) and the nodes (5 and above)
+typedef struct rw_str_ {
+  int            nNodes;                  // the number of AND nodes
+  unsigned char  pFans[2*RW_EX_NODES];    // the fanin literals of the nodes
+  unsigned char  Out;                     // the output literal
+  tt16           pTruths[5+RW_EX_NODES];  // the functions of the objects
+} rw_str;
+
+typedef struct rw_exact_ {
+  int            nClasses;                // the number of NPN classes
+  unsigned char *pClass;                  // the class of each function
+  int *          pTrans;                  // the transform of each function from the class structure (-1 = unknown)
+  rw_str *       pStrs;                   // the structures of each class (nNodes > RW_EX_NODES = unknown)
+  int *          pAlts;                   // the number of structures of each class
+  char           pPerms[RW_EX_PERMS][4];  // the input permutations
+} rw_exact;
+
+static tt16 s_Vars16[4] = { 0xAAAA, 0xCCCC, 0xF0F0, 0xFF00 };
+
+// input k of the function is replaced by input pPerm[k] complemented if bit k of Neg is set
+static inline tt16 Tt16_Transform( tt16 t, char * pPerm, int Neg )
+{
+  int m, k, x; tt16 r = 0;
+  for ( m = 0; m < 16; m++ ) {
+    for ( x = k = 0; k < 4; k++ )
+      x |= (((m >> pPerm[k]) ^ (Neg >> k)) & 1) << k;
+    r |= ((t >> x) & 1) << m;
+  }
+  return r;
+}
+// expresses the function of the leaves as the function of their superset
+static inline tt16 Tt16_Expand( tt16 t, int * pLeaves, int nLeaves, int * pLeavesNew, int nLeavesNew )
+{
+  char pPerm[4] = {0}; int k, n;
+  for ( k = n = 0; k < nLeaves; k++ ) {
+    while ( pLeavesNew[n] != pLeaves[k] )
+      n++;
+    pPerm[k] = n;
+  }
+  return nLeaves == nLeavesNew ? t : Tt16_Transform( t, pPerm, 0 );
+}
+static inline tt16 Rw_StrLitTruth( rw_str * p, int iLit )
+{
+  return p->pTruths[Lit2Var(iLit)] ^ (Lit2C(iLit) ? 0xFFFF : 0);
+}
+static inline int Rw_StrTruthFind( rw_str * p, tt16 t ) // returns the literal of the node with this function
+{
+  int i;
+  for ( i = 5; i < 5 + p->nNodes; i++ )
+    if ( p->pTruths[i] == t || (p->pTruths[i] ^ t) == 0xFFFF )
+      return Var2Lit( i, p->pTruths[i] != t );
+  return -1;
+}
+static inline int Rw_StrAddNode( rw_str * p, int l0, int l1 )
+{
+  tt16 t = Rw_StrLitTruth(p, l0) & Rw_StrLitTruth(p, l1);
+  int iLit = Rw_StrTruthFind( p, t ), iObj = 5 + p->nNodes;
+  if ( iLit >= 0 )
+    return iLit;
+  if ( p->nNodes == RW_EX_NODES )
+    return -1;
+  p->pFans[2*p->nNodes+0] = l0;
+  p->pFans[2*p->nNodes+1] = l1;
+  p->pTruths[iObj] = t;
+  p->nNodes++;
+  return Var2Lit( iObj, 0 );
+}
+// returns 1 if the structures have the same node functions
+static inline int Rw_StrSameNodes( rw_str * p, rw_str * q )
+{
+  int i;
+  if ( p->nNodes != q->nNodes )
+    return 0;
+  for ( i = 5; i < 5 + p->nNodes; i++ )
+    if ( Rw_StrTruthFind(q, p->pTruths[i]) < 0 )
+      return 0;
+  return 1;
+}
+// records the structure if it is smaller than those of its class or has the same size and different nodes
+static inline void Rw_StrRecord( rw_exact * p, int c, rw_str * pNew )
+{
+  rw_str * pStrs = p->pStrs + RW_EX_ALTS * c; int i;
+  if ( pNew->nNodes < pStrs->nNodes ) {
+    pStrs[0] = *pNew;
+    p->pAlts[c] = 1;
+    return;
+  }
+  if ( pNew->nNodes > pStrs->nNodes || p->pAlts[c] == RW_EX_ALTS )
+    return;
+  for ( i = 0; i < p->pAlts[c]; i++ )
+    if ( Rw_StrSameNodes(pStrs + i, pNew) )
+      return;
+  pStrs[p->pAlts[c]++] = *pNew;
+}
+// adds the structure of class pA transformed by (Perm, Neg) to the structure pB and combines the outputs
+static inline int Rw_StrCombine( rw_exact * p, rw_str * pNew, rw_str * pA, rw_str * pB, int Perm, int Neg, int cA, int cB )
+{
+  int pMap[5+RW_EX_NODES], k, lA;
+  *pNew = *pB;
+  pMap[0] = 0;
+  for ( k = 0; k < 4; k++ )
+    pMap[1+k] = Var2Lit( 1 + p->pPerms[Perm][k], (Neg >> k) & 1 );
+  for ( k = 0; k < pA->nNodes; k++ )
+    if ( (pMap[5+k] = Rw_StrAddNode( pNew, Lit2LitL(pMap, pA->pFans[2*k]), Lit2LitL(pMap, pA->pFans[2*k+1]) )) < 0 )
+      return 0;
+  lA = Lit2LitL(pMap, pA->Out) ^ cA;
+  if ( Rw_StrTruthFind( pNew, Rw_StrLitTruth(pNew, lA) & Rw_StrLitTruth(pNew, pB->Out ^ cB) ) >= 0 )
+    return 0;
+  if ( (lA = Rw_StrAddNode( pNew, lA, pB->Out ^ cB )) < 0 )
+    return 0;
+  pNew->Out = lA;
+  return 1;
+}
+static inline void Rw_ExactComputeClasses( rw_exact * p )
+{
+  int i, k, t, iHead, iTail, * pQueue = (int *)malloc( sizeof(int) * 65536 );
+  char pSwaps[3][4] = { {1,0,2,3}, {0,2,1,3}, {0,1,3,2} }, pIdent[4] = {0,1,2,3};
+  memset( p->pClass, 0xFF, 65536 );
+  for ( i = 0; i < 65536; i++ ) {
+    if ( p->pClass[i] != 0xFF )
+      continue;
+    p->pClass[i] = p->nClasses;
+    pQueue[0] = i;
+    for ( iHead = 0, iTail = 1; iHead < iTail; iHead++ ) {
+      tt16 pNext[8]; t = pQueue[iHead];
+      for ( k = 0; k < 3; k++ )
+        pNext[k] = Tt16_Transform( (tt16)t, pSwaps[k], 0 );
+      for ( k = 0; k < 4; k++ )
+        pNext[3+k] = Tt16_Transform( (tt16)t, pIdent, 1 << k );
+      pNext[7] = ~t;
+      for ( k = 0; k < 8; k++ )
+        if ( p->pClass[pNext[k]] == 0xFF )
+          p->pClass[pNext[k]] = p->nClasses, pQueue[iTail++] = pNext[k];
+    }
+    p->nClasses++;
+  }
+  free( pQueue );
+}
+static inline rw_exact * Rw_ExactStart( int fVerbose )
+{
+  rw_exact * p = (rw_exact *)calloc( sizeof(rw_exact), 1 );
+  iword clk = Time_Clock();
+  int a, b, c, v, k, T, cA, cB, nFinal = 0, nStamp = 0, nFound = 0;
+  int i0, i1, i2, i3;
+  for ( i0 = 0; i0 < 4; i0++ )
+  for ( i1 = 0; i1 < 4; i1++ )
+  for ( i2 = 0; i2 < 4; i2++ )
+  for ( i3 = 0; i3 < 4; i3++ )
+    if ( i0 != i1 && i0 != i2 && i0 != i3 && i1 != i2 && i1 != i3 && i2 != i3 ) {
+      p->pPerms[nFinal][0] = i0; p->pPerms[nFinal][1] = i1;
+      p->pPerms[nFinal][2] = i2; p->pPerms[nFinal][3] = i3; nFinal++;
+    }
+  assert( nFinal == RW_EX_PERMS );
+  p->pClass = (unsigned char *)malloc( 65536 );
+  p->pTrans = (int *)malloc( sizeof(int) * 65536 );
+  memset( p->pTrans, 0xFF, sizeof(int) * 65536 );
+  Rw_ExactComputeClasses( p );
+  p->pStrs  = (rw_str *)calloc( sizeof(rw_str), RW_EX_ALTS * p->nClasses );
+  p->pAlts  = (int *)calloc( sizeof(int), p->nClasses );
+  int * pFinal  = (int *)malloc( sizeof(int) * RW_EX_ALTS * p->nClasses );
+  int * pStamps = (int *)calloc( sizeof(int), 65536 );
+  tt16 * pTrOut = (tt16 *)malloc( sizeof(tt16) * RW_EX_TRANS * RW_EX_ALTS * p->nClasses );
+  for ( c = 0; c < RW_EX_ALTS * p->nClasses; c++ ) {
+    p->pStrs[c].nNodes = RW_EX_NODES + 1;
+    for ( k = 0; k < 4; k++ )
+      p->pStrs[c].pTruths[1+k] = s_Vars16[k];
+  }
+  // the constant and the buffer need no nodes
+  p->pStrs[RW_EX_ALTS * p->pClass[0]].nNodes = 0;
+  p->pStrs[RW_EX_ALTS * p->pClass[0]].Out    = 0;
+  p->pStrs[RW_EX_ALTS * p->pClass[s_Vars16[0]]].nNodes = 0;
+  p->pStrs[RW_EX_ALTS * p->pClass[s_Vars16[0]]].Out    = 2;
+  p->pAlts[p->pClass[0]] = p->pAlts[p->pClass[s_Vars16[0]]] = 1;
+  // the structures are finalized in the order of their size and combined with the finalized ones
+  nFinal = 0;
+  for ( v = 0; v <= RW_EX_NODES; v++ )
+  for ( b = 0; b < RW_EX_ALTS * p->nClasses; b++ ) {
+    rw_str * pB = p->pStrs + b, New;
+    if ( pB->nNodes != v || b % RW_EX_ALTS >= p->pAlts[b / RW_EX_ALTS] )
+      continue;
+    for ( T = 0; T < RW_EX_TRANS; T++ )
+      pTrOut[RW_EX_TRANS*b+T] = Tt16_Transform( Rw_StrLitTruth(pB, pB->Out), p->pPerms[T >> 4], T & 15 );
+    pFinal[nFinal++] = b;
+    for ( k = 0; k < nFinal; k++ ) {
+      rw_str * pA = p->pStrs + (a = pFinal[k]);
+      tt16 tB = Rw_StrLitTruth(pB, pB->Out);
+      nStamp++;
+      for ( T = 0; T < RW_EX_TRANS; T++ ) {
+        tt16 tA = pTrOut[RW_EX_TRANS*a+T];
+        if ( pStamps[tA] == nStamp )
+          continue;
+        pStamps[tA] = nStamp;
+        for ( cA = 0; cA < 2; cA++ )
+        for ( cB = 0; cB < 2; cB++ ) {
+          int nLower = 1 + (pA->nNodes > pB->nNodes ? pA->nNodes : pB->nNodes);
+          c = p->pClass[(tt16)((cA ? ~tA : tA) & (cB ? ~tB : tB))];
+          if ( p->pStrs[RW_EX_ALTS * c].nNodes < nLower || (p->pStrs[RW_EX_ALTS * c].nNodes == nLower && p->pAlts[c] == RW_EX_ALTS) )
+            continue;
+          if ( Rw_StrCombine( p, &New, pA, pB, T >> 4, T & 15, cA, cB ) )
+            Rw_StrRecord( p, c, &New );
+        }
+      }
+    }
+  }
+  for ( c = 0; c < p->nClasses; c++ )
+    nFound += p->pStrs[RW_EX_ALTS * c].nNodes <= RW_EX_NODES;
+  if ( fVerbose ) {
+    printf( "Exact synthesis library: %d out of %d NPN classes with up to %d nodes.  ", nFound, p->nClasses, RW_EX_NODES );
+    Time_Print( "Time", Time_Clock() - clk );
+    printf( "\n" );
+  }
+  free( pFinal );
+  free( pStamps );
+  free( pTrOut );
+  return p;
+}
+// the library shared by several runs, each with its own transform cache (the rest is read-only)
+static inline void Rw_ExactShare( rw_exact * pNew, rw_exact * p )
+{
+  *pNew = *p;
+  pNew->pTrans = (int *)malloc( sizeof(int) * 65536 );
+  memset( pNew->pTrans, 0xFF, sizeof(int) * 65536 );
+}
+static inline void Rw_ExactStop( rw_exact * p )
+{
+  free( p->pClass );
+  free( p->pTrans );
+  free( p->pStrs );
+  free( p->pAlts );
+  free( p );
+}
+// returns the transform (Perm, Neg, output complement) of the class structure that gives the function
+static inline int Rw_ExactTransform( rw_exact * p, tt16 t )
+{
+  rw_str * pStr = p->pStrs + RW_EX_ALTS * p->pClass[t];
+  tt16 tStr = Rw_StrLitTruth(pStr, pStr->Out), tRes;
+  int T;
+  if ( p->pTrans[t] >= 0 )
+    return p->pTrans[t];
+  for ( T = 0; T < RW_EX_TRANS; T++ ) {
+    tRes = Tt16_Transform( tStr, p->pPerms[T >> 4], T & 15 );
+    if ( tRes == t || (tRes ^ t) == 0xFFFF )
+      return p->pTrans[t] = (T << 1) | (tRes != t);
+  }
+  assert( 0 );
+  return -1;
+}
+
+// cuts of the two-input AIG
+typedef struct rw_cut_ {
+  int            nLeaves;
+  int            pLeaves[4];
+  tt16           Truth;
+} rw_cut;
+
+static inline int Rw_CutMerge( rw_cut * pCut, rw_cut * p0, rw_cut * p1 )
+{
+  int i = 0, k = 0;
+  pCut->nLeaves = 0;
+  while ( i < p0->nLeaves || k < p1->nLeaves ) {
+    if ( pCut->nLeaves == 4 )
+      return 0;
+    if ( k == p1->nLeaves || (i < p0->nLeaves && p0->pLeaves[i] < p1->pLeaves[k]) )
+      pCut->pLeaves[pCut->nLeaves++] = p0->pLeaves[i++];
+    else if ( i == p0->nLeaves || p0->pLeaves[i] > p1->pLeaves[k] )
+      pCut->pLeaves[pCut->nLeaves++] = p1->pLeaves[k++];
+    else
+      pCut->pLeaves[pCut->nLeaves++] = p0->pLeaves[i++], k++;
+  }
+  return 1;
+}
+static inline int Rw_CutDominated( rw_cut * pCut, rw_cut * pCuts, int nCuts ) // returns 1 if a subset is present
+{
+  int c, i, k;
+  for ( c = 0; c < nCuts; c++ ) {
+    for ( i = k = 0; i < pCuts[c].nLeaves && k < pCut->nLeaves; k++ )
+      i += pCuts[c].pLeaves[i] == pCut->pLeaves[k];
+    if ( i == pCuts[c].nLeaves )
+      return 1;
+  }
+  return 0;
+}
+static inline void Rw_CutTrivial( rw_cut * pCut, int iObj )
+{
+  pCut->nLeaves = 1;
+  pCut->pLeaves[0] = iObj;
+  pCut->Truth = s_Vars16[0];
+}
+// computes the cuts of the nodes (the trivial cuts are not stored)
+static inline rw_cut * Rw_ExactCuts( maig * p, int * pnCuts )
+{
+  rw_cut * pCuts = (rw_cut *)malloc( sizeof(rw_cut) * RW_EX_CUTS * p->nObjs ), Triv0, Triv1, Cut;
+  int i, c0, c1;
+  memset( pnCuts, 0, sizeof(int) * p->nObjs );
+  Maig_ForEachNode( p, i ) {
+    int iLit0 = Maig_ObjFanin0(p, i), iLit1 = Maig_ObjFanin1(p, i);
+    int iFan0 = Lit2Var(iLit0), iFan1 = Lit2Var(iLit1);
+    rw_cut * pCuts0 = pCuts + RW_EX_CUTS * iFan0, * pCuts1 = pCuts + RW_EX_CUTS * iFan1, * pCut0, * pCut1;
+    rw_cut * pRes = pCuts + RW_EX_CUTS * i;
+    Rw_CutTrivial( &Triv0, iFan0 );
+    Rw_CutTrivial( &Triv1, iFan1 );
+    for ( c0 = -1; c0 < pnCuts[iFan0]; c0++ )
+    for ( c1 = -1; c1 < pnCuts[iFan1] && pnCuts[i] < RW_EX_CUTS; c1++ ) {
+      pCut0 = c0 < 0 ? &Triv0 : pCuts0 + c0;
+      pCut1 = c1 < 0 ? &Triv1 : pCuts1 + c1;
+      if ( !Rw_CutMerge( &Cut, pCut0, pCut1 ) || Rw_CutDominated( &Cut, pRes, pnCuts[i] ) )
+        continue;
+      Cut.Truth = (Tt16_Expand( pCut0->Truth, pCut0->pLeaves, pCut0->nLeaves, Cut.pLeaves, Cut.nLeaves ) ^ (Lit2C(iLit0) ? 0xFFFF : 0)) &
+                  (Tt16_Expand( pCut1->Truth, pCut1->pLeaves, pCut1->nLeaves, Cut.pLeaves, Cut.nLeaves ) ^ (Lit2C(iLit1) ? 0xFFFF : 0));
+      pRes[pnCuts[i]++] = Cut;
+    }
+  }
+  return pCuts;
+}
+static inline int Rw_CutHasLeaf( rw_cut * pCut, int iObj )
+{
+  int k;
+  for ( k = 0; k < pCut->nLeaves; k++ )
+    if ( pCut->pLeaves[k] == iObj )
+      return 1;
+  return 0;
+}
+// collects the MFFC of the node above the cut and returns its size
+static inline int Rw_ExactMffc_rec( maig * p, int iObj, int * pRefs, rw_cut * pCut, vi * vMffc )
+{
+  int k, iLit, Count = 1;
+  Vi_Push( vMffc, iObj );
+  Maig_ForEachObjFanin( p, iObj, iLit, k ) {
+    int iFan = Lit2Var(iLit);
+    if ( iFan <= p->nIns || Rw_CutHasLeaf(pCut, iFan) )
+      continue;
+    if ( --pRefs[iFan] == 0 )
+      Count += Rw_ExactMffc_rec( p, iFan, pRefs, pCut, vMffc );
+  }
+  return Count;
+}
+static inline int Rw_ExactMffc( maig * p, int iObj, int * pRefs, rw_cut * pCut, vi * vMffc )
+{
+  int i, k, iNode, iLit, Count;
+  Vi_Shrink( vMffc, 0 );
+  Count = Rw_ExactMffc_rec( p, iObj, pRefs, pCut, vMffc );
+  Vi_ForEachEntry( vMffc, iNode, i )
+    Maig_ForEachObjFanin( p, iNode, iLit, k )
+      if ( Lit2Var(iLit) > p->nIns && !Rw_CutHasLeaf(pCut, Lit2Var(iLit)) )
+        pRefs[Lit2Var(iLit)]++;
+  return Count;
+}
+// builds the structure of the cut function in the new AIG
+static inline int Rw_ExactBuild( rw_exact * pEx, maig * pNew, maig * p, rw_cut * pCut )
+{
+  int Trans = Rw_ExactTransform( pEx, pCut->Truth ), T = Trans >> 1, k;
+  rw_str * pStr = pEx->pStrs + RW_EX_ALTS * pEx->pClass[pCut->Truth];
+  int pMap[5+RW_EX_NODES];
+  pMap[0] = 0;
+  for ( k = 0; k < 4; k++ ) { // the inputs outside of the cut are not used by the function
+    int iLeaf = pEx->pPerms[T >> 4][k];
+    pMap[1+k] = iLeaf < pCut->nLeaves ? p->pCopy[pCut->pLeaves[iLeaf]] ^ ((T >> k) & 1) : 0;
+  }
+  for ( k = 0; k < pStr->nNodes; k++ )
+    pMap[5+k] = Maig_BuildNode( pNew, Lit2LitL(pMap, pStr->pFans[2*k]), Lit2LitL(pMap, pStr->pFans[2*k+1]), 1, 1 );
+  return Lit2LitL(pMap, pStr->Out) ^ (Trans & 1);
+}
+// replaces the cones of the two-input AIG by smaller structures from the library
+static inline maig * Rw_Exact( maig * p, rw_exact * pEx, int * pnReplaced )
+{
+  int * pnCuts = (int *)malloc( sizeof(int) * p->nObjs );
+  int * pRefs  = (int *)calloc( sizeof(int), p->nObjs );
+  int * pMarks = (int *)calloc( sizeof(int), p->nObjs ); // 1 = in the MFFC of a replaced node, 2 = the leaf of a replaced node
+  int * pSels  = (int *)malloc( sizeof(int) * p->nObjs );
+  rw_cut * pCuts = Rw_ExactCuts( p, pnCuts ), * pCut;
+  vi * vMffc = Vi_Alloc( 100 );
+  int i, k, c, iLit, iNode, nAllocs = 1 + p->nIns + p->nOuts + Maig_CountAnd2(p);
+  maig * pNew, * pTemp;
+  *pnReplaced = 0;
+  memset( pSels, 0xFF, sizeof(int) * p->nObjs );
+  Maig_ForEachNodeOutput( p, i )
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      pRefs[Lit2Var(iLit)]++;
+  // select the replacements starting from the outputs
+  Maig_ForEachNodeReverse( p, i ) {
+    int BestGain = 0, BestCut = -1;
+    if ( pRefs[i] == 0 || pMarks[i] == 1 )
+      continue;
+    for ( c = 0; c < pnCuts[i]; c++ ) {
+      int nSize = pEx->pStrs[RW_EX_ALTS * pEx->pClass[(pCut = pCuts + RW_EX_CUTS * i + c)->Truth]].nNodes;
+      if ( nSize > RW_EX_NODES )
+        continue;
+      for ( k = 0; k < pCut->nLeaves; k++ )
+        if ( pMarks[pCut->pLeaves[k]] == 1 )
+          break;
+      if ( k < pCut->nLeaves || Rw_ExactMffc(p, i, pRefs, pCut, vMffc) - nSize <= BestGain )
+        continue;
+      Vi_ForEachEntry( vMffc, iNode, k )
+        if ( pMarks[iNode] == 2 )
+          break;
+      if ( k < Vi_Size(vMffc) )
+        continue;
+      BestGain = Vi_Size(vMffc) - nSize;
+      BestCut  = c;
+    }
+    if ( BestCut == -1 )
+      continue;
+    pSels[i] = BestCut;
+    pCut = pCuts + RW_EX_CUTS * i + BestCut;
+    Rw_ExactMffc( p, i, pRefs, pCut, vMffc );
+    Vi_ForEachEntry( vMffc, iNode, k )
+      if ( iNode != i )
+        pMarks[iNode] = 1;
+    for ( k = 0; k < pCut->nLeaves; k++ )
+      pMarks[pCut->pLeaves[k]] = 2;
+    nAllocs += pEx->pStrs[RW_EX_ALTS * pEx->pClass[pCut->Truth]].nNodes;
+    (*pnReplaced)++;
+  }
+  // rebuild the AIG
+  pNew = Maig_Alloc( p->nIns, p->nOuts, nAllocs );
+  pNew->nRegs = p->nRegs;
+  pNew->TableSize = Abc_PrimeCudd( 3 * (nAllocs - p->nIns - p->nOuts) ); 
+  pNew->pTable = (int *)calloc( sizeof(int), 3*pNew->TableSize );
+  memset( p->pCopy, 0, sizeof(int)*p->nObjs );
+  Maig_ForEachInput( p, i )
+    p->pCopy[i] = Var2Lit(i, 0);
+  Maig_ForEachNode( p, i )
+    if ( pSels[i] >= 0 )
+      p->pCopy[i] = Rw_ExactBuild( pEx, pNew, p, pCuts + RW_EX_CUTS * i + pSels[i] );
+    else
+      p->pCopy[i] = Maig_BuildNode( pNew, Lit2LitL(p->pCopy, Maig_ObjFanin0(p, i)), Lit2LitL(p->pCopy, Maig_ObjFanin1(p, i)), 1, 1 );
+  Maig_ForEachOutput( p, i )
+    Maig_AppendFanin(pNew, Maig_AppendObj(pNew), Lit2LitL(p->pCopy, Maig_ObjFanin0(p, i)));
+  pNew = Maig_Dup( pTemp = pNew, 1 );
+  Maig_Free( pTemp );
+  free( pnCuts );
+  free( pRefs );
+  free( pMarks );
+  free( pSels );
+  free( pCuts );
+  Vi_Free( vMffc );
+  if ( Maig_CountAnd2(pNew) < Maig_CountAnd2(p) )
+    return pNew;
+  Maig_Free( pNew );
+  *pnReplaced = 0;
+  return Maig_Dup( p, 0 );
+}
+
+/*************************************************************
+             combinational equivalence checking
+**************************************************************/
+
+// A compact CDCL SAT solver (two watched literals, first-UIP learning, VSIDS,
+// phase saving and Luby restarts) called incrementally under assumptions.
+// The literals are encoded as in the AIG (Var2Lit), so the variable of each
+// CNF literal is the object of the miter it comes from.
+
+#define RW_SAT_SAT      1
+#define RW_SAT_UNSAT    0
+#define RW_SAT_UNDEC   -1
+#define RW_SAT_RESTART 100   // the number of conflicts in the unit of the Luby restart sequence
+#define RW_SAT_LEARNT  (1<<16) // the initial limit on the literals in the learned clauses
+#define RW_SAT_KEEP    8     // the learned clauses of this size or less survive the reduction
+
+typedef struct rw_sat_ {
+  int     nVars;        // the number of variables
+  int     fUnsat;       // the clauses are unsatisfiable without assumptions
+  vi      vClauses;     // the clauses stored as [2*size+learned, lit0, lit1, ...]
+  vi *    pWatches;     // the clauses watching each literal (visited when it becomes false)
+  signed char * pAssign;// the values of the variables (-1 = unassigned)
+  char *  pPhase;       // the complement of the last value of each variable (the saved phase)
+  char *  pSeen;        // the marks used by the conflict analysis
+  char *  pModel;       // the satisfying assignment found by the last call
+  int *   pLevel;       // the decision level of each variable
+  int *   pReason;      // the clause implying each variable (-1 = decision)
+  double * pActs;       // the activities of the variables
+  double  ActInc;       // the current activity increment
+  int *   pHeap;        // the heap of the variables ordered by activity
+  int *   pHeapPos;     // the position of each variable in the heap (-1 = not in the heap)
+  int     nHeap;        // the heap size
+  vi      vTrail;       // the assigned literals
+  vi      vTrailLim;    // the trail size at each decision level
+  vi      vLearnt;      // the clause being learned
+  int     iQhead;       // the next trail literal to propagate
+  int     nLearntLits;  // the number of literals in the learned clauses
+  int     nLearntMax;   // the limit on this number that triggers the reduction
+  iword   nConflicts;   // the statistics
+  iword   nDecisions;
+} rw_sat;
+
+static inline int   Rw_SatLevel( rw_sat * p )           { return Vi_Size(&p->vTrailLim);                                   }
+static inline int   Rw_SatValue( rw_sat * p, int Lit )  { int v = p->pAssign[Lit2Var(Lit)]; return v < 0 ? v : v ^ Lit2C(Lit); }
+static inline int * Rw_SatClause( rw_sat * p, int h )   { return Vi_Array(&p->vClauses) + h + 1;                           }
+static inline int   Rw_SatClauseSize( int * pC )        { return pC[-1] >> 1;                                              }
+
+static inline void Rw_SatHeapUp( rw_sat * p, int i )
+{
+  int v = p->pHeap[i];
+  while ( i > 0 && p->pActs[v] > p->pActs[p->pHeap[(i-1)/2]] ) {
+    p->pHeap[i] = p->pHeap[(i-1)/2];
+    p->pHeapPos[p->pHeap[i]] = i;
+    i = (i-1)/2;
+  }
+  p->pHeap[i] = v;
+  p->pHeapPos[v] = i;
+}
+static inline void Rw_SatHeapDown( rw_sat * p, int i )
+{
+  int v = p->pHeap[i], c;
+  while ( (c = 2*i+1) < p->nHeap ) {
+    if ( c+1 < p->nHeap && p->pActs[p->pHeap[c+1]] > p->pActs[p->pHeap[c]] )
+      c++;
+    if ( p->pActs[p->pHeap[c]] <= p->pActs[v] )
+      break;
+    p->pHeap[i] = p->pHeap[c];
+    p->pHeapPos[p->pHeap[i]] = i;
+    i = c;
+  }
+  p->pHeap[i] = v;
+  p->pHeapPos[v] = i;
+}
+static inline void Rw_SatHeapInsert( rw_sat * p, int v )
+{
+  if ( p->pHeapPos[v] >= 0 )
+    return;
+  p->pHeap[p->nHeap] = v;
+  Rw_SatHeapUp( p, p->nHeap++ );
+}
+static inline int Rw_SatHeapPop( rw_sat * p )
+{
+  int v = p->pHeap[0];
+  p->pHeapPos[v] = -1;
+  if ( --p->nHeap > 0 ) {
+    p->pHeap[0] = p->pHeap[p->nHeap];
+    Rw_SatHeapDown( p, 0 );
+  }
+  return v;
+}
+static inline void Rw_SatBump( rw_sat * p, int v )
+{
+  int i;
+  if ( (p->pActs[v] += p->ActInc) > 1e100 ) {
+    for ( i = 0; i < p->nVars; i++ )
+      p->pActs[i] *= 1e-100;
+    p->ActInc *= 1e-100;
+  }
+  if ( p->pHeapPos[v] >= 0 )
+    Rw_SatHeapUp( p, p->pHeapPos[v] );
+}
+
+// the variables are decided only after they are added by Rw_SatHeapInsert()
+static inline rw_sat * Rw_SatStart( int nVars )
+{
+  rw_sat * p = (rw_sat *)calloc( sizeof(rw_sat), 1 );
+  p->nVars    = nVars;
+  p->pWatches = (vi *)calloc( sizeof(vi), 2*nVars );
+  p->pAssign  = (signed char *)malloc( nVars );
+  p->pPhase   = (char *)malloc( nVars );
+  p->pSeen    = (char *)calloc( nVars, 1 );
+  p->pModel   = (char *)calloc( nVars, 1 );
+  p->pLevel   = (int *)calloc( sizeof(int), nVars );
+  p->pReason  = (int *)calloc( sizeof(int), nVars );
+  p->pActs    = (double *)calloc( sizeof(double), nVars );
+  p->pHeap    = (int *)malloc( sizeof(int)*nVars );
+  p->pHeapPos = (int *)malloc( sizeof(int)*nVars );
+  p->ActInc   = 1.0;
+  p->nLearntMax = RW_SAT_LEARNT;
+  memset( p->pAssign, -1, nVars );
+  memset( p->pPhase, 1, nVars ); // the variables are tried with value 0 first
+  memset( p->pHeapPos, -1, sizeof(int)*nVars );
+  Vi_Start( &p->vClauses, 4*nVars + 100 );
+  Vi_Start( &p->vTrail, nVars + 1 );
+  Vi_Start( &p->vTrailLim, 100 );
+  Vi_Start( &p->vLearnt, 100 );
+  return p;
+}
+static inline void Rw_SatStop( rw_sat * p )
+{
+  int i;
+  for ( i = 0; i < 2*p->nVars; i++ )
+    Vi_Stop( p->pWatches + i );
+  Vi_Stop( &p->vClauses );
+  Vi_Stop( &p->vTrail );
+  Vi_Stop( &p->vTrailLim );
+  Vi_Stop( &p->vLearnt );
+  free( p->pWatches );
+  free( p->pAssign );
+  free( p->pPhase );
+  free( p->pSeen );
+  free( p->pModel );
+  free( p->pLevel );
+  free( p->pReason );
+  free( p->pActs );
+  free( p->pHeap );
+  free( p->pHeapPos );
+  free( p );
+}
+
+static inline void Rw_SatEnqueue( rw_sat * p, int Lit, int h )
+{
+  int v = Lit2Var(Lit);
+  p->pAssign[v] = !Lit2C(Lit);
+  p->pLevel[v]  = Rw_SatLevel(p);
+  p->pReason[v] = h;
+  Vi_Push( &p->vTrail, Lit );
+}
+static inline void Rw_SatCancel( rw_sat * p, int Level )
+{
+  int i, v;
+  if ( Rw_SatLevel(p) <= Level )
+    return;
+  for ( i = Vi_Size(&p->vTrail) - 1; i >= Vi_Read(&p->vTrailLim, Level); i-- ) {
+    v = Lit2Var( Vi_Read(&p->vTrail, i) );
+    p->pPhase[v]  = !p->pAssign[v];
+    p->pAssign[v] = -1;
+    Rw_SatHeapInsert( p, v );
+  }
+  p->iQhead = Vi_Read( &p->vTrailLim, Level );
+  Vi_Shrink( &p->vTrail, p->iQhead );
+  Vi_Shrink( &p->vTrailLim, Level );
+}
+static inline int Rw_SatStore( rw_sat * p, int * pLits, int nLits, int fLearnt )
+{
+  int h = Vi_Size(&p->vClauses), i;
+  assert( nLits > 1 );
+  p->nLearntLits += fLearnt ? nLits : 0;
+  Vi_Push( &p->vClauses, 2*nLits + fLearnt );
+  for ( i = 0; i < nLits; i++ )
+    Vi_Push( &p->vClauses, pLits[i] );
+  Vi_Push( p->pWatches + pLits[0], h );
+  Vi_Push( p->pWatches + pLits[1], h );
+  return h;
+}
+// returns the conflicting clause or -1
+static inline int Rw_SatPropagate( rw_sat * p )
+{
+  int h, i, j, k, n, * pC;
+  while ( p->iQhead < Vi_Size(&p->vTrail) ) {
+    int LitF = LitNot( Vi_Read(&p->vTrail, p->iQhead++) );
+    vi * vW = p->pWatches + LitF;
+    for ( i = j = 0, n = Vi_Size(vW); i < n; i++ ) {
+      h  = vW->ptr[i];
+      pC = Rw_SatClause( p, h );
+      if ( pC[0] == LitF ) // the false literal is always the second one
+        pC[0] = pC[1], pC[1] = LitF;
+      if ( Rw_SatValue(p, pC[0]) == 1 ) {
+        vW->ptr[j++] = h;
+        continue;
+      }
+      for ( k = 2; k < Rw_SatClauseSize(pC); k++ )
+        if ( Rw_SatValue(p, pC[k]) != 0 )
+          break;
+      if ( k < Rw_SatClauseSize(pC) ) { // found another literal to watch
+        pC[1] = pC[k], pC[k] = LitF;
+        Vi_Push( p->pWatches + pC[1], h );
+        continue;
+      }
+      vW->ptr[j++] = h;
+      if ( Rw_SatValue(p, pC[0]) == 0 ) {
+        for ( i++; i < n; i++ )
+          vW->ptr[j++] = vW->ptr[i];
+        vW->size = j;
+        return h;
+      }
+      Rw_SatEnqueue( p, pC[0], h );
+    }
+    vW->size = j;
+  }
+  return -1;
+}
+// derives the first-UIP clause in vLearnt and returns the backtrack level
+static inline int Rw_SatAnalyze( rw_sat * p, int h )
+{
+  int i, j, k, v, Lit = -1, nPaths = 0, iTrail = Vi_Size(&p->vTrail) - 1, Level = 0;
+  vi * vLearnt = &p->vLearnt;
+  Vi_Fill( vLearnt, 1, -1 );
+  do {
+    int * pC = Rw_SatClause( p, h );
+    for ( k = (Lit == -1 ? 0 : 1); k < Rw_SatClauseSize(pC); k++ ) {
+      v = Lit2Var( pC[k] );
+      if ( p->pSeen[v] || p->pLevel[v] == 0 )
+        continue;
+      p->pSeen[v] = 1;
+      Rw_SatBump( p, v );
+      if ( p->pLevel[v] == Rw_SatLevel(p) )
+        nPaths++;
+      else
+        Vi_Push( vLearnt, pC[k] );
+    }
+    while ( !p->pSeen[Lit2Var(Vi_Read(&p->vTrail, iTrail))] )
+      iTrail--;
+    Lit = Vi_Read( &p->vTrail, iTrail-- );
+    h   = p->pReason[Lit2Var(Lit)];
+    p->pSeen[Lit2Var(Lit)] = 0;
+  } while ( --nPaths > 0 );
+  Vi_Write( vLearnt, 0, LitNot(Lit) );
+  // the literals implied by the other literals are moved to the end
+  for ( i = j = 1; i < Vi_Size(vLearnt); i++ ) {
+    if ( (h = p->pReason[Lit2Var(Vi_Read(vLearnt, i))]) >= 0 ) {
+      int * pC = Rw_SatClause( p, h );
+      for ( k = 1; k < Rw_SatClauseSize(pC); k++ )
+        if ( !p->pSeen[Lit2Var(pC[k])] && p->pLevel[Lit2Var(pC[k])] > 0 )
+          break;
+      if ( k == Rw_SatClauseSize(pC) )
+        continue;
+    }
+    RW_SWAP( int, vLearnt->ptr[i], vLearnt->ptr[j] );
+    j++;
+  }
+  for ( i = 1; i < Vi_Size(vLearnt); i++ )
+    p->pSeen[Lit2Var(Vi_Read(vLearnt, i))] = 0;
+  Vi_Shrink( vLearnt, j );
+  // the literal of the backtrack level is watched with the asserting literal
+  for ( i = 1; i < Vi_Size(vLearnt); i++ ) {
+    v = Lit2Var( Vi_Read(vLearnt, i) );
+    if ( Level < p->pLevel[v] ) {
+      Level = p->pLevel[v];
+      RW_SWAP( int, vLearnt->ptr[1], vLearnt->ptr[i] );
+    }
+  }
+  return Level;
+}
+// adds a clause when no decisions are made (returns 0 if the clauses became unsatisfiable)
+static inline int Rw_SatAddClause( rw_sat * p, int * pLits, int nLits )
+{
+  int i;
+  assert( Rw_SatLevel(p) == 0 );
+  if ( p->fUnsat )
+    return 0;
+  Vi_Shrink( &p->vLearnt, 0 );
+  for ( i = 0; i < nLits; i++ )
+    if ( Rw_SatValue(p, pLits[i]) == 1 )
+      return 1;
+    else if ( Rw_SatValue(p, pLits[i]) == -1 && Vi_Find(&p->vLearnt, pLits[i]) == -1 )
+      Vi_Push( &p->vLearnt, pLits[i] );
+  if ( Vi_Size(&p->vLearnt) == 0 )
+    p->fUnsat = 1;
+  else if ( Vi_Size(&p->vLearnt) == 1 ) {
+    Rw_SatEnqueue( p, Vi_Read(&p->vLearnt, 0), -1 );
+    p->fUnsat = Rw_SatPropagate(p) >= 0;
+  }
+  else
+    Rw_SatStore( p, Vi_Array(&p->vLearnt), Vi_Size(&p->vLearnt), 0 );
+  return !p->fUnsat;
+}
+// removes the long learned clauses (without decisions, the reasons are not used by the analysis)
+static inline void Rw_SatReduce( rw_sat * p )
+{
+  int h, i, nLits, hNew = 0, * pArray = Vi_Array(&p->vClauses);
+  assert( Rw_SatLevel(p) == 0 );
+  for ( i = 0; i < 2*p->nVars; i++ )
+    Vi_Shrink( p->pWatches + i, 0 );
+  p->nLearntLits = 0;
+  for ( h = 0; h < Vi_Size(&p->vClauses); h += 1 + nLits ) {
+    nLits = pArray[h] >> 1;
+    if ( (pArray[h] & 1) && nLits > RW_SAT_KEEP )
+      continue;
+    p->nLearntLits += (pArray[h] & 1) ? nLits : 0;
+    memmove( pArray + hNew, pArray + h, sizeof(int) * (1 + nLits) );
+    Vi_Push( p->pWatches + pArray[hNew+1], hNew );
+    Vi_Push( p->pWatches + pArray[hNew+2], hNew );
+    hNew += 1 + nLits;
+  }
+  Vi_Shrink( &p->vClauses, hNew );
+  p->nLearntMax = MaxInt( p->nLearntMax, 2 * p->nLearntLits );
+}
+static inline int Rw_SatLuby( int i ) // the i-th element of the sequence 1,1,2,1,1,2,4,1,...
+{
+  int Size, Seq;
+  for ( Size = 1, Seq = 0; Size < i + 1; Seq++ )
+    Size = 2*Size + 1;
+  while ( Size - 1 != i ) {
+    Size = (Size - 1) >> 1;
+    Seq--;
+    i = i % Size;
+  }
+  return 1 << Seq;
+}
+// the assumptions are the first decisions; the model is saved in pModel
+static inline int Rw_SatSolve( rw_sat * p, int * pAssumps, int nAssumps, int nConfLimit )
+{
+  int h, v, Lit, nConfs = 0, nConfsRestart = 0, nRestarts = 0;
+  if ( p->fUnsat )
+    return RW_SAT_UNSAT;
+  assert( Rw_SatLevel(p) == 0 );
+  if ( p->nLearntLits > p->nLearntMax )
+    Rw_SatReduce( p );
+  while ( 1 ) {
+    if ( (h = Rw_SatPropagate(p)) >= 0 ) {
+      p->nConflicts++, nConfs++, nConfsRestart++;
+      if ( Rw_SatLevel(p) == 0 ) {
+        p->fUnsat = 1;
+        return RW_SAT_UNSAT;
+      }
+      Rw_SatCancel( p, Rw_SatAnalyze(p, h) );
+      Lit = Vi_Read( &p->vLearnt, 0 );
+      Rw_SatEnqueue( p, Lit, Vi_Size(&p->vLearnt) == 1 ? -1 : Rw_SatStore(p, Vi_Array(&p->vLearnt), Vi_Size(&p->vLearnt), 1) );
+      p->ActInc *= 1 / 0.95;
+      if ( nConfLimit && nConfs >= nConfLimit ) {
+        Rw_SatCancel( p, 0 );
+        return RW_SAT_UNDEC;
+      }
+      continue;
+    }
+    if ( nConfsRestart >= RW_SAT_RESTART * Rw_SatLuby(nRestarts) ) {
+      nConfsRestart = 0, nRestarts++;
+      Rw_SatCancel( p, 0 );
+      if ( p->nLearntLits > p->nLearntMax )
+        Rw_SatReduce( p );
+      continue;
+    }
+    for ( Lit = -1; Rw_SatLevel(p) < nAssumps; ) {
+      int Value = Rw_SatValue( p, pAssumps[Rw_SatLevel(p)] );
+      if ( Value == 0 ) {
+        Rw_SatCancel( p, 0 );
+        return RW_SAT_UNSAT;
+      }
+      if ( Value == -1 ) {
+        Lit = pAssumps[Rw_SatLevel(p)];
+        break;
+      }
+      Vi_Push( &p->vTrailLim, Vi_Size(&p->vTrail) ); // the assumption holds already
+    }
+    if ( Lit == -1 ) {
+      while ( p->nHeap > 0 && p->pAssign[p->pHeap[0]] >= 0 )
+        Rw_SatHeapPop( p );
+      if ( p->nHeap == 0 ) {
+        for ( v = 0; v < p->nVars; v++ )
+          p->pModel[v] = p->pAssign[v] == 1;
+        Rw_SatCancel( p, 0 );
+        return RW_SAT_SAT;
+      }
+      v   = Rw_SatHeapPop( p );
+      Lit = Var2Lit( v, p->pPhase[v] );
+      p->nDecisions++;
+    }
+    Vi_Push( &p->vTrailLim, Vi_Size(&p->vTrail) );
+    Rw_SatEnqueue( p, Lit, -1 );
+  }
+}
+
+// The two networks are combined into a structurally hashed miter. Random simulation
+// groups its objects into candidate classes of equivalence (up to complement), which
+// are proved in the topological order; each proved pair becomes two binary clauses
+// (SAT sweeping), and each disproved pair adds a counter-example to the simulation.
+// Finally, the outputs are compared by simulation and, if needed, by SAT. The clauses 
+// of a node are loaded into the solver when its cone is first used in a proof.
+// The networks with few inputs are instead compared on all input patterns.
+
+#define RW_CEC_EXHAUST     20      // the largest number of inputs for which all patterns are simulated
+#define RW_CEC_WORDS       16      // the number of random simulation words
+#define RW_CEC_CEXS        16      // the number of words storing the counter-examples of the sweeping
+#define RW_CEC_SIMS        (RW_CEC_WORDS + RW_CEC_CEXS)
+#define RW_CEC_CONF_NODE   1000    // the conflict limit when proving internal equivalences
+#define RW_CEC_CONF_OUT    1000000 // the conflict limit when proving the outputs
+#define RW_CEC_PRINT       5       // the number of printed counter-examples
+
+typedef struct rw_cec_ {
+  maig *   pMiter;      // the miter (the outputs of the first network followed by those of the second one)
+  rw_sat * pSat;        // the solver with the clauses of the miter
+  char *   pLoaded;     // the objects whose clauses are loaded
+  word *   pSims;       // the simulation info of the objects
+  int      nCexs;       // the number of counter-examples added to the simulation info
+  int *    pTable;      // the hash table of the class representatives
+  int      TableSize;   // the size of the hash table
+  vi *     vReprs;      // the class representatives
+  int      nProved;     // the statistics
+  int      nDisproved;
+  int      nUndec;
+} rw_cec;
+
+// creates the miter with the outputs of the first network followed by those of the second one
+static inline maig * Maig_Miter( maig * p1, maig * p2 )
+{
+  int n, i, k, iLit, nObjsAlloc = 1 + p1->nIns + 2 * p1->nOuts + Maig_CountAnd2(p1) + Maig_CountAnd2(p2);
+  maig * pNets[2] = { p1, p2 }, * p, * pNew = Maig_Alloc( p1->nIns, 2 * p1->nOuts, nObjsAlloc );
+  assert( p1->nIns == p2->nIns && p1->nOuts == p2->nOuts );
+  pNew->TableSize = Abc_PrimeCudd( 3 * nObjsAlloc );
+  pNew->pTable = (int *)calloc( sizeof(int), 3*pNew->TableSize );
+  for ( n = 0; n < 2; n++ ) {
+    p = pNets[n];
+    Maig_ForEachConstInput( p, i )
+      p->pCopy[i] = Var2Lit(i, 0);
+    Maig_ForEachNode( p, i ) {
+      assert( Maig_ObjFaninNum(p, i) > 0 );
+      Maig_ForEachObjFanin( p, i, iLit, k )
+        p->pCopy[i] = k ? Maig_BuildNode(pNew, p->pCopy[i], Lit2LitL(p->pCopy, iLit), 1, 1) : Lit2LitL(p->pCopy, iLit);
+    }
+  }
+  for ( n = 0; n < 2; n++ ) {
+    p = pNets[n];
+    Maig_ForEachOutput( p, i )
+      Maig_AppendFanin( pNew, Maig_AppendObj(pNew), Lit2LitL(p->pCopy, Maig_ObjFanin0(p, i)) );
+  }
+  return pNew;
+}
+
+static inline word * Rw_CecSim( rw_cec * p, int i )   { return p->pSims + RW_CEC_SIMS * i;        }
+static inline int    Rw_CecPhase( rw_cec * p, int i ) { return (int)(Rw_CecSim(p, i)[0] & 1);     }
+
+static inline void Rw_CecSimulate( rw_cec * p, int iStart, int nWords )
+{
+  maig * pM = p->pMiter; int i, w;
+  Maig_ForEachNode( pM, i ) {
+    int iLit0 = Maig_ObjFanin0(pM, i), iLit1 = Maig_ObjFanin1(pM, i);
+    word * pSim  = Rw_CecSim( p, i );
+    word * pSim0 = Rw_CecSim( p, Lit2Var(iLit0) ), c0 = Lit2C(iLit0) ? ~(word)0 : 0;
+    word * pSim1 = Rw_CecSim( p, Lit2Var(iLit1) ), c1 = Lit2C(iLit1) ? ~(word)0 : 0;
+    for ( w = iStart; w < iStart + nWords; w++ )
+      pSim[w] = (pSim0[w] ^ c0) & (pSim1[w] ^ c1);
+  }
+}
+// the simulation info is compared after normalizing the phase of the first pattern
+static inline int Rw_CecEqual( rw_cec * p, int i, int j )
+{
+  word * pSim0 = Rw_CecSim(p, i), * pSim1 = Rw_CecSim(p, j), Mask = ((pSim0[0] ^ pSim1[0]) & 1) ? ~(word)0 : 0; int w;
+  for ( w = 0; w < RW_CEC_SIMS; w++ )
+    if ( pSim0[w] != (pSim1[w] ^ Mask) )
+      return 0;
+  return 1;
+}
+// returns the representative of the class of the object or inserts the object as a new representative
+static inline int Rw_CecLookup( rw_cec * p, int i, int fInsert )
+{
+  word * pSim = Rw_CecSim(p, i), Mask = Rw_CecPhase(p, i) ? ~(word)0 : 0, Hash = 0; int w, Key;
+  for ( w = 0; w < RW_CEC_SIMS; w++ )
+    Hash = Rw_HashMix( Hash ^ pSim[w] ^ Mask );
+  for ( Key = (int)(Hash % (word)p->TableSize); p->pTable[Key] >= 0; Key = (Key + 1) % p->TableSize )
+    if ( Rw_CecEqual(p, i, p->pTable[Key]) )
+      return p->pTable[Key];
+  if ( fInsert )
+    p->pTable[Key] = i;
+  return -1;
+}
+// adds the model of the solver as a counter-example and refines the classes
+static inline int Rw_CecAddCex( rw_cec * p )
+{
+  maig * pM = p->pMiter; int i, iRepr, w = RW_CEC_WORDS + p->nCexs / 64;
+  if ( p->nCexs == 64 * RW_CEC_CEXS )
+    return 0;
+  Maig_ForEachInput( pM, i )
+    if ( p->pSat->pModel[i] )
+      Rw_CecSim(p, i)[w] |= (word)1 << (p->nCexs % 64);
+  p->nCexs++;
+  Rw_CecSimulate( p, w, 1 );
+  for ( i = 0; i < p->TableSize; i++ )
+    p->pTable[i] = -1;
+  Vi_ForEachEntry( p->vReprs, iRepr, i )
+    Rw_CecLookup( p, iRepr, 1 );
+  return 1;
+}
+static inline void Rw_CecLoad_rec( rw_cec * p, int i )
+{
+  maig * pM = p->pMiter; int pLits[3];
+  if ( p->pLoaded[i] )
+    return;
+  p->pLoaded[i] = 1;
+  Rw_SatHeapInsert( p->pSat, i );
+  if ( i == 0 ) {
+    pLits[0] = Var2Lit(0, 1);
+    Rw_SatAddClause( p->pSat, pLits, 1 );
+  }
+  if ( !Maig_ObjIsNode(pM, i) )
+    return;
+  Rw_CecLoad_rec( p, Lit2Var(Maig_ObjFanin0(pM, i)) );
+  Rw_CecLoad_rec( p, Lit2Var(Maig_ObjFanin1(pM, i)) );
+  pLits[0] = Var2Lit(i, 1), pLits[1] = Maig_ObjFanin0(pM, i);
+  Rw_SatAddClause( p->pSat, pLits, 2 );
+  pLits[0] = Var2Lit(i, 1), pLits[1] = Maig_ObjFanin1(pM, i);
+  Rw_SatAddClause( p->pSat, pLits, 2 );
+  pLits[0] = Var2Lit(i, 0), pLits[1] = LitNot(Maig_ObjFanin0(pM, i)), pLits[2] = LitNot(Maig_ObjFanin1(pM, i));
+  Rw_SatAddClause( p->pSat, pLits, 3 );
+}
+// proves that the literals are equal and records this in the solver (returns RW_SAT_UNSAT if they are)
+static inline int Rw_CecProve( rw_cec * p, int iLit0, int iLit1, int nConfLimit )
+{
+  int pLits[2] = { iLit0, LitNot(iLit1) }, Status;
+  rw_sat * pSat = p->pSat;
+  if ( iLit0 == iLit1 )
+    return RW_SAT_UNSAT;
+  Rw_CecLoad_rec( p, Lit2Var(iLit0) );
+  Rw_CecLoad_rec( p, Lit2Var(iLit1) );
+  if ( (Status = Rw_SatSolve(pSat, pLits, 2, nConfLimit)) != RW_SAT_UNSAT )
+    return Status;
+  pLits[0] = LitNot(iLit0), pLits[1] = iLit1;
+  if ( (Status = Rw_SatSolve(pSat, pLits, 2, nConfLimit)) != RW_SAT_UNSAT )
+    return Status;
+  Rw_SatAddClause( pSat, pLits, 2 );
+  pLits[0] = iLit0, pLits[1] = LitNot(iLit1);
+  Rw_SatAddClause( pSat, pLits, 2 );
+  return RW_SAT_UNSAT;
+}
+static inline void Rw_CecSweep( rw_cec * p )
+{
+  maig * pM = p->pMiter; int i, iRepr, Status;
+  for ( i = 0; i < pM->nObjs - pM->nOuts; i++ )
+    while ( 1 ) {
+      if ( (iRepr = Rw_CecLookup(p, i, 1)) == -1 ) {
+        Vi_Push( p->vReprs, i );
+        break;
+      }
+      Status = Rw_CecProve( p, Var2Lit(iRepr, Rw_CecPhase(p, iRepr) ^ Rw_CecPhase(p, i)), Var2Lit(i, 0), RW_CEC_CONF_NODE );
+      if ( Status == RW_SAT_UNSAT ) {
+        p->nProved++;
+        break;
+      }
+      if ( Status == RW_SAT_UNDEC || !Rw_CecAddCex(p) ) {
+        p->nUndec++;
+        break;
+      }
+      p->nDisproved++;
+    }
+}
+// returns the first pattern where the literals differ (or -1)
+static inline int Rw_CecSimDiff( rw_cec * p, int iLit0, int iLit1 )
+{
+  word * pSim0 = Rw_CecSim(p, Lit2Var(iLit0)), * pSim1 = Rw_CecSim(p, Lit2Var(iLit1));
+  word Mask = Lit2C(iLit0) ^ Lit2C(iLit1) ? ~(word)0 : 0; int w, b;
+  for ( w = 0; w < RW_CEC_SIMS; w++ )
+    if ( pSim0[w] ^ pSim1[w] ^ Mask )
+      for ( b = 0; b < 64; b++ )
+        if ( ((pSim0[w] ^ pSim1[w] ^ Mask) >> b) & 1 )
+          return 64 * w + b;
+  return -1;
+}
+// simulates the block of input patterns starting from Base (the patterns are enumerated exhaustively)
+static inline void Rw_CecSimBlock( rw_cec * p, word Base )
+{
+  maig * pM = p->pMiter; int i, w;
+  Maig_ForEachInput( pM, i )
+    for ( w = 0; w < RW_CEC_SIMS; w++ )
+      Rw_CecSim(p, i)[w] = i <= 6 ? s_Truths6[i-1] : (((Base + 64*w) >> (i-1)) & 1) ? ~(word)0 : 0;
+  Rw_CecSimulate( p, 0, RW_CEC_SIMS );
+}
+// the value of the literal under the simulation pattern (or under the model of the solver if iPat is -1)
+static inline int Rw_CecValue( rw_cec * p, int iLit, int iPat )
+{
+  return (iPat >= 0 ? Tt_GetBit(Rw_CecSim(p, Lit2Var(iLit)), iPat) : p->pSat->pModel[Lit2Var(iLit)]) ^ Lit2C(iLit);
+}
+static inline void Rw_CecPrintCex( rw_cec * p, int iOut, int iLit0, int iLit1, int iPat )
+{
+  int i;
+  printf( "Output %d differs (%d vs %d) under the input pattern ", iOut, Rw_CecValue(p, iLit0, iPat), Rw_CecValue(p, iLit1, iPat) );
+  Maig_ForEachInput( p->pMiter, i )
+    printf( "%d", Rw_CecValue(p, Var2Lit(i, 0), iPat) );
+  printf( "\n" );
+}
+
+// checks the combinational equivalence of two networks (returns 1 if equivalent, 0 if not, -1 if undecided;
+// the registers are matched by their order, so the next-state functions are compared as outputs);
+// the networks with few inputs are simulated exhaustively, the others are compared by SAT sweeping
+int Rw_CecPerform( maig * p1, maig * p2, int nSeed, int fVerbose )
+{
+  rw_cec Cec, * p = &Cec; rw_rng Rng; maig * pM;
+  int i, k, w, iPat, nOuts = p1->nOuts, nFailed = 0, nUndecOuts = 0, * pStatus;
+  iword clk = Time_Clock();
+  word Base;
+  if ( p1->nIns != p2->nIns || p1->nOuts != p2->nOuts || p1->nRegs != p2->nRegs ) {
+    printf( "The networks cannot be compared because they have different numbers of inputs (%d and %d), outputs (%d and %d) or registers (%d and %d).\n",
+      p1->nIns - p1->nRegs, p2->nIns - p2->nRegs, p1->nOuts - p1->nRegs, p2->nOuts - p2->nRegs, p1->nRegs, p2->nRegs );
+    return 0;
+  }
+  memset( p, 0, sizeof(rw_cec) );
+  p->pMiter = pM = Maig_Miter( p1, p2 );
+  p->pSims  = (word *)calloc( sizeof(word), RW_CEC_SIMS * pM->nObjs );
+  pStatus   = (int *)calloc( sizeof(int), nOuts ); // RW_SAT_UNSAT means that the outputs are equal
+#define Rw_CecOutLit0( k ) Maig_ObjFanin0( pM, pM->nObjs - 2*nOuts + (k) )
+#define Rw_CecOutLit1( k ) Maig_ObjFanin0( pM, pM->nObjs - nOuts + (k) )
+  if ( pM->nIns <= RW_CEC_EXHAUST ) {
+    for ( Base = 0; Base < ((word)1 << pM->nIns) && nFailed < nOuts; Base += 64 * RW_CEC_SIMS ) {
+      Rw_CecSimBlock( p, Base );
+      for ( k = 0; k < nOuts; k++ )
+        if ( pStatus[k] == RW_SAT_UNSAT && (iPat = Rw_CecSimDiff(p, Rw_CecOutLit0(k), Rw_CecOutLit1(k))) >= 0 ) {
+          pStatus[k] = RW_SAT_SAT;
+          if ( nFailed++ < RW_CEC_PRINT )
+            Rw_CecPrintCex( p, k, Rw_CecOutLit0(k), Rw_CecOutLit1(k), iPat );
+        }
+    }
+    if ( fVerbose )
+      printf( "Miter:  AND = %d  Patterns = %.0f (exhaustive simulation)\n", Maig_CountAnd2(pM), (double)((word)1 << pM->nIns) );
+  }
+  else {
+    // random simulation and sweeping
+    p->pSat    = Rw_SatStart( pM->nObjs - pM->nOuts );
+    p->pLoaded = (char *)calloc( pM->nObjs, 1 );
+    Rng_Start( &Rng, nSeed );
+    Maig_ForEachInput( pM, i )
+      for ( w = 0; w < RW_CEC_WORDS; w++ )
+        Rw_CecSim(p, i)[w] = Rng_Next( &Rng );
+    Rw_CecSimulate( p, 0, RW_CEC_SIMS );
+    p->TableSize = Abc_PrimeCudd( 2 * pM->nObjs + 1 );
+    p->pTable = (int *)malloc( sizeof(int) * p->TableSize );
+    for ( i = 0; i < p->TableSize; i++ )
+      p->pTable[i] = -1;
+    p->vReprs = Vi_Alloc( 1000 );
+    Rw_CecSweep( p );
+    if ( fVerbose )
+      printf( "Miter:  AND = %d  Classes = %d  Proved = %d  Disproved = %d  Undecided = %d  Conflicts = %lld\n",
+        Maig_CountAnd2(pM), Vi_Size(p->vReprs), p->nProved, p->nDisproved, p->nUndec, (long long)p->pSat->nConflicts );
+    // the outputs
+    for ( k = 0; k < nOuts; k++ ) {
+      if ( (iPat = Rw_CecSimDiff(p, Rw_CecOutLit0(k), Rw_CecOutLit1(k))) >= 0 )
+        pStatus[k] = RW_SAT_SAT;
+      else if ( (pStatus[k] = Rw_CecProve(p, Rw_CecOutLit0(k), Rw_CecOutLit1(k), RW_CEC_CONF_OUT)) == RW_SAT_UNDEC )
+        nUndecOuts++;
+      if ( pStatus[k] == RW_SAT_SAT && nFailed++ < RW_CEC_PRINT )
+        Rw_CecPrintCex( p, k, Rw_CecOutLit0(k), Rw_CecOutLit1(k), iPat );
+      if ( pStatus[k] == RW_SAT_SAT && iPat == -1 )
+        Rw_CecAddCex( p ); // the pattern may distinguish the remaining outputs
+    }
+    if ( fVerbose )
+      printf( "Outputs:  Conflicts = %lld  Decisions = %lld\n", (long long)p->pSat->nConflicts, (long long)p->pSat->nDecisions );
+    Rw_SatStop( p->pSat );
+    free( p->pLoaded );
+    free( p->pTable );
+    Vi_Free( p->vReprs );
+  }
+#undef Rw_CecOutLit0
+#undef Rw_CecOutLit1
+  if ( nFailed )
+    printf( "Networks are NOT EQUIVALENT:  %d out of %d outputs differ%s.  ", nFailed, nOuts, nFailed > RW_CEC_PRINT ? " (the first few are printed)" : "" );
+  else if ( nUndecOuts )
+    printf( "Networks are UNDECIDED:  %d out of %d outputs are not proved within %d conflicts.  ", nUndecOuts, nOuts, RW_CEC_CONF_OUT );
+  else
+    printf( "Networks are equivalent.  " );
+  Time_Print( "Time", Time_Clock() - clk );
+  printf( "\n" );
+  free( pStatus );
+  free( p->pSims );
+  Maig_Free( pM );
+  return nFailed ? 0 : nUndecOuts ? -1 : 1;
+}
+
+/*************************************************************
+                  high-level rewiring code
+**************************************************************/
+
+// parameters of the rewiring run
+typedef struct rw_par_ {
+  int     nIters;       // the number of iterations
+  int     nExpands;     // the number of nodes to expand
+  int     nGrowth;      // the number of fanins that can be added
+  int     nDivs;        // the number of shared divisors to extract
+  int     nFaninMax;    // the limit on the fanin count at a node
+  int     nSeed;        // the random seed
+  int     nTimeOut;     // the timeout in seconds
+  int     nLayout;      // the node/truth table layout (0 = as is, 1 = DFS order, 2 = DFS order and blocked simulation)
+  int     nMemLimit;    // the memory limit for truth tables in MB (0 = no limit)
+  int     nThreads;     // the number of threads simulating large truth tables
+  int     nBatch;       // the number of nodes expanded/reduced speculatively at a time (0 = one by one)
+  int     nPartSupp;    // the support size limit of the output partitions (0 = no partitioning)
+  int     nRedecomp;    // the percentage of supergates re-decomposed in each iteration (others reuse their cascades)
+  int     nResub;       // the resubstitution level (0 = none, 1 = single divisors, 2 = pairs of divisors)
+  int     fExact;       // enables replacement of 4-input cuts by the structures from the exact synthesis library
+  int     fWeighted;    // enables expansion order weighted by the MFFC size and the earlier success
+  int     fAdapt;       // enables adaptive control of the expansion/sharing parameters
+  int     nAccept;      // the acceptance strategy (0 = elitist, 1 = simulated annealing, 2 = late acceptance, 3 = threshold accepting)
+  int     nAcceptPar;   // the initial temperature/threshold in AND2 nodes or the history length (0 = automatic)
+  int     fXorMux;      // the XOR/MUX clusters become single nodes of the multi-input network
+  int     fCareOuts;    // the second half of the outputs are the care sets of the first half
+  char *  pFileCare;    // the AIGER file with the care sets of the outputs
+  word *  pCareOuts;    // the external care sets of the outputs (NULL = completely specified)
+  char *  pCacheDir;    // the directory of the solution cache (NULL = unused)
+  char *  pFileSnap;    // the snapshot of the run written periodically and resumed from if it exists (NULL = unused)
+  char *  pFileCec;     // the AIGER file checked for equivalence with the input (NULL = optimization is performed)
+  int     nBench;       // the time of each microbenchmark in milliseconds (0 = optimization is performed)
+  rw_pool * pPool;      // the threads simulating large truth tables (NULL = one thread)
+  int     fQuiet;       // suppresses the progress report (used for the parts of a partitioned run)
+  int     fVerbose;     // the verbosity level
+} rw_par;
+
+// adaptive control uses one bandit for each of the parameters -E, -G, -D and -F,
+// which selects among three values around the user's setting by their AND2 reduction per second
+// of the time measured by Time_Clock (the CPU time, or the wall time when compiled with LIN/LIN64)
+#define RW_ADAPT_PARS   4     // the number of controlled parameters
+#define RW_ADAPT_VALS   3     // the number of values of each parameter
+#define RW_ADAPT_DECAY  0.99  // the discount of the statistics (lets the controller follow the run)
+
+typedef struct rw_adapt_ {
+  int     pValues[RW_ADAPT_PARS][RW_ADAPT_VALS]; // the values of each parameter
+  double  pGains [RW_ADAPT_PARS][RW_ADAPT_VALS]; // the discounted AND2 reduction
+  double  pTimes [RW_ADAPT_PARS][RW_ADAPT_VALS]; // the discounted runtime
+  double  pPulls [RW_ADAPT_PARS][RW_ADAPT_VALS]; // the discounted number of uses
+  int     pUses  [RW_ADAPT_PARS][RW_ADAPT_VALS]; // the number of uses
+  int     pChoice[RW_ADAPT_PARS];                // the values used in the current iteration
+} rw_adapt;
+
+static inline int * Rw_AdaptParam( rw_par * pPars, int k )
+{
+  if ( k == 0 ) return &pPars->nExpands;
+  if ( k == 1 ) return &pPars->nGrowth;
+  if ( k == 2 ) return &pPars->nDivs;
+  return &pPars->nFaninMax;
+}
+static inline void Rw_AdaptStart( rw_adapt * p, rw_par * pPars )
+{
+  int k, Value;
+  memset( p, 0, sizeof(rw_adapt) );
+  for ( k = 0; k < RW_ADAPT_PARS; k++ ) {
+    Value = *Rw_AdaptParam( pPars, k );
+    p->pValues[k][0] = (k == 0 || k == 2) ? MaxInt(1, Value/2) : MaxInt(k == 3 ? 2 : 1, Value-1);
+    p->pValues[k][1] = Value;
+    p->pValues[k][2] = (k == 0 || k == 2) ? MaxInt(1, 2*Value) : Value+1;
+  }
+}
+// selects the values by the upper confidence bound of the normalized productivity
+static inline void Rw_AdaptSelect( rw_adapt * p, rw_par * pPars, rw_rng * pRng )
+{
+  int k, j, v, vBest;
+  for ( k = 0; k < RW_ADAPT_PARS; k++ ) {
+    double Total = 0, RateMax = 0, Score, ScoreBest = -1;
+    for ( v = 0; v < RW_ADAPT_VALS; v++ ) {
+      Total += p->pPulls[k][v];
+      if ( p->pTimes[k][v] > 0 && RateMax < p->pGains[k][v]/p->pTimes[k][v] )
+        RateMax = p->pGains[k][v]/p->pTimes[k][v];
+    }
+    for ( j = 0; j < RW_ADAPT_VALS; j++ ) // try each value once (staggered to combine different values)
+      if ( p->pUses[k][(j + k) % RW_ADAPT_VALS] == 0 )
+        break;
+    if ( j < RW_ADAPT_VALS )
+      vBest = (j + k) % RW_ADAPT_VALS;
+    else if ( Rng_Bound(pRng, 4) == 0 ) // random exploration keeps the choices of different parameters independent
+      vBest = Rng_Bound(pRng, RW_ADAPT_VALS);
+    else for ( vBest = v = 0; v < RW_ADAPT_VALS; v++ ) {
+      Score = (RateMax > 0 ? p->pGains[k][v]/p->pTimes[k][v]/RateMax : 0) + sqrt( 2*log(Total)/p->pPulls[k][v] );
+      if ( ScoreBest < Score )
+        ScoreBest = Score, vBest = v;
+    }
+    p->pChoice[k] = vBest;
+    *Rw_AdaptParam( pPars, k ) = p->pValues[k][vBest];
+  }
+}
+static inline void Rw_AdaptUpdate( rw_adapt * p, int Gain, iword Time )
+{
+  int k, v;
+  for ( k = 0; k < RW_ADAPT_PARS; k++ ) {
+    for ( v = 0; v < RW_ADAPT_VALS; v++ ) {
+      p->pGains[k][v] *= RW_ADAPT_DECAY;
+      p->pTimes[k][v] *= RW_ADAPT_DECAY;
+      p->pPulls[k][v] *= RW_ADAPT_DECAY;
+    }
+    v = p->pChoice[k];
+    p->pGains[k][v] += MaxInt( Gain, 0 );
+    p->pTimes[k][v] += (double)MaxInt( (int)Time, 1 ) / CLOCKS_PER_SEC;
+    p->pPulls[k][v] += 1;
+    p->pUses[k][v]++;
+  }
+}
+static inline void Rw_AdaptPrint( rw_adapt * p )
+{
+  int k, v;
+  printf( "Adaptive control (value : iterations) :" );
+  for ( k = 0; k < RW_ADAPT_PARS; k++ ) {
+    printf( "  %c =", "EGDF"[k] );
+    for ( v = 0; v < RW_ADAPT_VALS; v++ )
+      printf( " %d:%d", p->pValues[k][v], p->pUses[k][v] );
+  }
+  printf( "\n" );
+}
+
+// non-elitist strategies walk from the current solution, which may be worse than the best one;
+// the temperature (annealing) and the threshold (threshold accepting) decrease over the iterations,
+// while late acceptance compares with the current cost recorded a fixed number of iterations ago
+#define RW_ACCEPT_COOL  0.01  // the final temperature relative to the initial one
+
+typedef struct rw_accept_ {
+  int     nAccept;      // the acceptance strategy
+  int     nIters;       // the number of iterations
+  double  Start;        // the initial temperature or threshold
+  int     nHist;        // the history length of late acceptance
+  int *   pHist;        // the history of late acceptance
+  int     nAccepted;    // the number of accepted worse solutions
+} rw_accept;
+
+static inline void Rw_AcceptStart( rw_accept * p, rw_par * pPars, int nAnds )
+{
+  int i;
+  memset( p, 0, sizeof(rw_accept) );
+  p->nAccept = pPars->nAccept;
+  p->nIters  = pPars->nIters;
+  p->Start   = pPars->nAcceptPar ? pPars->nAcceptPar : 1 + nAnds / 200;
+  if ( p->nAccept != 2 )
+    return;
+  p->nHist   = pPars->nAcceptPar ? pPars->nAcceptPar : 100;
+  p->pHist   = (int *)malloc( sizeof(int)*p->nHist );
+  for ( i = 0; i < p->nHist; i++ )
+    p->pHist[i] = nAnds;
+}
+static inline void Rw_AcceptStop( rw_accept * p )
+{
+  if ( p->pHist ) free( p->pHist );
+}
+// returns 1 if the new solution replaces the current one
+static inline int Rw_AcceptCheck( rw_accept * p, int iIter, int nCur, int nNew, rw_rng * pRng )
+{
+  double Ratio = (double)iIter / p->nIters;
+  int fAccept = nNew <= nCur;
+  if ( p->nAccept == 1 ) {
+    double Temp = p->Start * pow( RW_ACCEPT_COOL, Ratio );
+    if ( !fAccept )
+      fAccept = Rng_Real(pRng) < exp( -(nNew - nCur) / Temp );
+  }
+  else if ( p->nAccept == 2 ) {
+    int * pSlot = p->pHist + iIter % p->nHist;
+    if ( !fAccept )
+      fAccept = nNew <= *pSlot;
+    *pSlot = fAccept ? nNew : nCur;
+  }
+  else if ( p->nAccept == 3 ) {
+    if ( !fAccept )
+      fAccept = nNew - nCur <= p->Start * (1.0 - Ratio);
+  }
+  p->nAccepted += fAccept && nNew > nCur;
+  return fAccept;
+}
+
+static inline vi * Rw_CreateOrder( maig * p, rw_rng * pRng )
+{
+  int i;
+  Vi_Shrink( p->vOrder, 0 );
+  Maig_ForEachNode( p, i )
+    Vi_Push( p->vOrder, i );
+  Vi_Randomize( p->vOrder, pRng );
+  return p->vOrder;
+}
+
+// the weighted order of expansion samples the nodes without replacement, with the weight growing 
+// with the log of the MFFC size and with the success rate of the earlier expansions of the nodes 
+// with the same function (the node IDs change in every iteration while most of the functions remain);
+// the reduction keeps the uniform order because it visits all nodes anyway
+#define RW_PRIO_BITS   16     // the number of bits in the key of the score table
+#define RW_PRIO_DECAY  0.95f  // the discount of the earlier attempts
+
+typedef struct rw_prio_ {
+  float   pTries[1 << RW_PRIO_BITS];     // the discounted number of expansion attempts
+  float   pWins [1 << RW_PRIO_BITS];     // the discounted number of expansions that added fanins
+} rw_prio;
+
+typedef struct rw_prio_key_ {
+  float   Key;
+  int     iObj;
+} rw_prio_key;
+
+static int Rw_PrioCompare( const void * p1, const void * p2 )
+{
+  float k1 = ((rw_prio_key *)p1)->Key, k2 = ((rw_prio_key *)p2)->Key;
+  return k1 < k2 ? -1 : k1 > k2;
+}
+static inline int Rw_PrioKey( maig * p, int iObj )
+{
+  word Truth = Maig_ObjTruth(p, iObj, 0)[0];
+  if ( Truth & 1 ) // the key does not depend on the polarity
+    Truth = ~Truth;
+  return (int)((Truth * 0x9E3779B97F4A7C15ull) >> (64 - RW_PRIO_BITS));
+}
+static inline void Rw_PrioUpdate( rw_prio * p, int Key, int fSuccess )
+{
+  p->pTries[Key] = p->pTries[Key] * RW_PRIO_DECAY + 1;
+  p->pWins [Key] = p->pWins [Key] * RW_PRIO_DECAY + (fSuccess != 0);
+}
+// creates the order after the truth tables are computed and returns the score keys of the nodes
+static inline vi * Rw_CreateOrderWeighted( maig * p, rw_prio * pPrio, int ** ppKeys, rw_rng * pRng )
+{
+  rw_prio_key * pItems = (rw_prio_key *)malloc( sizeof(rw_prio_key) * p->nObjs );
+  int i, n = 0, * pKeys = *ppKeys = (int *)malloc( sizeof(int) * p->nObjs );
+  Maig_ForEachNode( p, i ) {
+    int   Key    = pKeys[i] = Rw_PrioKey( p, i );
+    int   nMffc  = p->pRefs[i] > 0 ? Maig_ObjDerefCount_rec( p, i ) : 0;
+    float Rate   = (pPrio->pWins[Key] + 1) / (pPrio->pTries[Key] + 2);
+    float Weight = (1 + log2f(1 + nMffc)) * (0.25f + Rate) * (0.25f + Rate);
+    if ( p->pRefs[i] > 0 )
+      Maig_ObjRef_rec( p, i );
+    // the smallest values of -log(u)/w give a weighted sample without replacement
+    pItems[n].Key  = -logf( 1.0f - (float)Rng_Real(pRng) ) / Weight;
+    pItems[n].iObj = i; n++;
+  }
+  qsort( pItems, n, sizeof(rw_prio_key), Rw_PrioCompare );
+  Vi_Shrink( p->vOrder, 0 );
+  for ( i = 0; i < n; i++ )
+    Vi_Push( p->vOrder, pItems[i].iObj );
+  free( pItems );
+  return p->vOrder;
+}
+// The nodes of a batch are evaluated concurrently against the same network, each by 
+// a thread working on its own view (a copy of the network header with private marks, 
+// care set and complemented tables, which shares the fanins and the truth tables). 
+// The results are then committed in the order of the nodes. A commit changes the 
+// fanins of the node, the functions of some nodes in its TFO (those whose tables 
+// differ after the update) and adds fanouts to the new fanins, so a later result 
+// is used only if its TFO, the side inputs of the TFO and the new fanins were not 
+// changed; otherwise, the node is evaluated again on the current network. 
+// This way, the result depends on the batch size but not on the number of threads.
+// Reduction removes fanins, which may also replace the fanins of the dangling nodes 
+// by constants (see Maig_ObjDeref_rec) and changes the reference counts used to 
+// order the fanins, so its results also require the same fanins and counts of the 
+// node. Reduction does not use random numbers, so it gives the same result as the 
+// evaluation of the nodes one by one.
+
+typedef struct rw_spec_ {
+  int       iObj;       // the node
+  int       nLimit;     // the limit on the number of fanins to add
+  rw_rng    Rng;        // the random number stream of this node
+  vi *      vTfo;       // the TFO of the node (the node comes first)
+  vi *      vFound;     // the fanins found for the node (or its constant)
+  vi *      vFanins;    // the fanins of the node and their reference counts (used by reduction)
+  int       Status;     // the result of reduction
+} rw_spec;
+
+typedef struct rw_batch_ {
+  maig *    p;          // the network
+  rw_engine * pEng;     // the engine used by the network
+  int       fReduce;    // the nodes are reduced rather than expanded
+  int       nViews;     // the number of views (one for each thread)
+  maig *    pViews;     // the views
+  int       nSpecs;     // the number of nodes in the current batch
+  int       nSpecsAlloc;// the number of allocated nodes
+  rw_spec * pSpecs;     // the nodes in the current batch
+  int       iBatch;     // the batch counter
+  int *     pChanged;   // the last batch in which the function of the object has changed
+  int *     pGrown;     // the last batch in which the object has gained a fanout
+  word *    pSaved;     // the tables of the TFO before the update
+  int       nSavedAlloc;// the number of allocated tables
+  int       nRedos;     // the number of nodes evaluated again
+} rw_batch;
+
+static inline rw_batch * Rw_BatchStart( maig * p, rw_engine * pEng, int nBatch )
+{
+  rw_batch * pBat = (rw_batch *)calloc( sizeof(rw_batch), 1 ); int i;
+  assert( !p->nSlots );
+  pBat->p           = p;
+  pBat->pEng        = pEng;
+  pBat->nViews      = p->pPool ? p->pPool->nThreads : 1;
+  pBat->pViews      = (maig *)calloc( sizeof(maig), pBat->nViews );
+  for ( i = 0; i < pBat->nViews; i++ ) {
+    maig * pView      = pBat->pViews + i;
+    *pView            = *p;
+    pView->nTravIds   = 0;
+    pView->pTravIds   = (int *)calloc( sizeof(int), p->nObjs );
+    pView->pTruths[1] = (word *)calloc( sizeof(word), p->nWords*p->nObjs );
+    pView->pCare      = (word *)calloc( sizeof(word), p->nWords );
+    pView->pProd      = (word *)calloc( sizeof(word), p->nWords );
+    pView->vOrderF    = Vi_Alloc( 1000 );
+    pView->vOrderF2   = Vi_Alloc( 1000 );
+    pView->vTfo       = Vi_Alloc( 1000 );
+    pView->pPool      = NULL;
+  }
+  pBat->nSpecsAlloc = nBatch;
+  pBat->pSpecs      = (rw_spec *)calloc( sizeof(rw_spec), nBatch );
+  for ( i = 0; i < nBatch; i++ ) {
+    pBat->pSpecs[i].vTfo   = Vi_Alloc( 100 );
+    pBat->pSpecs[i].vFound = Vi_Alloc( 100 );
+    pBat->pSpecs[i].vFanins = Vi_Alloc( 100 );
+  }
+  pBat->pChanged    = (int *)calloc( sizeof(int), p->nObjs );
+  pBat->pGrown      = (int *)calloc( sizeof(int), p->nObjs );
+  return pBat;
+}
+static inline void Rw_BatchStop( rw_batch * p )
+{
+  int i;
+  for ( i = 0; i < p->nViews; i++ ) {
+    maig * pView = p->pViews + i;
+    free( pView->pTravIds );
+    free( pView->pTruths[1] );
+    free( pView->pCare );
+    free( pView->pProd );
+    Vi_Free( pView->vOrderF );
+    Vi_Free( pView->vOrderF2 );
+    Vi_Free( pView->vTfo );
+  }
+  for ( i = 0; i < p->nSpecsAlloc; i++ ) {
+    Vi_Free( p->pSpecs[i].vTfo );
+    Vi_Free( p->pSpecs[i].vFound );
+    Vi_Free( p->pSpecs[i].vFanins );
+  }
+  free( p->pViews );
+  free( p->pSpecs );
+  free( p->pChanged );
+  free( p->pGrown );
+  if ( p->pSaved ) free( p->pSaved );
+  free( p );
+}
+// evaluates the nodes of the batch assigned to this thread
+static void Rw_BatchJob( void * pArg, int iThread, int nThreads )
+{
+  rw_batch * p = (rw_batch *)pArg; 
+  maig * pView = p->pViews + iThread; int i, k, iLit;
+  for ( i = iThread; i < p->nSpecs; i += nThreads ) {
+    rw_spec * pSpec = p->pSpecs + i;
+    if ( p->fReduce ) {
+      Vi_Shrink( pSpec->vFanins, 0 );
+      Maig_ForEachObjFanin( pView, pSpec->iObj, iLit, k ) {
+        Vi_Push( pSpec->vFanins, iLit );
+        Vi_Push( pSpec->vFanins, pView->pRefs[Lit2Var(iLit)] );
+      }
+      pSpec->Status = p->pEng->pFuncReduceFind( pView, pSpec->iObj, 0, 0, pSpec->vFound );
+    }
+    else {
+      pView->pRng = &pSpec->Rng;
+      Vi_Shrink( pSpec->vFound, 0 );
+      p->pEng->pFuncExpandFind( pView, pSpec->iObj, pSpec->nLimit, pSpec->vFound );
+    }
+    Vi_Shrink( pSpec->vTfo, 0 );
+    Vi_PushArray( pSpec->vTfo, Vi_Array(pView->vTfo), Vi_Size(pView->vTfo) );
+  }
+}
+// returns 1 if the result does not depend on the changes committed earlier in this batch
+static inline int Rw_BatchValid( rw_batch * p, rw_spec * pSpec )
+{
+  int i, k, iObj, iLit;
+  Vi_ForEachEntry( pSpec->vTfo, iObj, i ) {
+    if ( p->pChanged[iObj] == p->iBatch || p->pGrown[iObj] == p->iBatch )
+      return 0;
+    Maig_ForEachObjFanin( p->p, iObj, iLit, k )
+      if ( p->pChanged[Lit2Var(iLit)] == p->iBatch )
+        return 0;
+  }
+  if ( p->fReduce ) {
+    if ( Vi_Size(pSpec->vFanins) != 2 * Maig_ObjFaninNum(p->p, pSpec->iObj) )
+      return 0;
+    Maig_ForEachObjFanin( p->p, pSpec->iObj, iLit, k )
+      if ( Vi_Read(pSpec->vFanins, 2*k) != iLit || Vi_Read(pSpec->vFanins, 2*k+1) != p->p->pRefs[Lit2Var(iLit)] )
+        return 0;
+    return 1;
+  }
+  Vi_ForEachEntry( pSpec->vFound, iLit, i )
+    if ( p->pChanged[Lit2Var(iLit)] == p->iBatch )
+      return 0;
+  return 1;
+}
+// updates the TFO after the node is changed and records the changed functions
+static inline void Rw_BatchUpdate( rw_batch * p, vi * vTfo )
+{
+  maig * pMaig = p->p; int i, iObj, nWords = pMaig->nWords;
+  if ( p->nSavedAlloc < Vi_Size(vTfo) ) {
+    p->nSavedAlloc = 2 * Vi_Size(vTfo);
+    p->pSaved = (word *)realloc( p->pSaved, sizeof(word)*nWords*p->nSavedAlloc );
+  }
+  Vi_ForEachEntry( vTfo, iObj, i )
+    Tt_Dup( p->pSaved + nWords*i, Maig_ObjTruth(pMaig, iObj, 0), nWords );
+  p->pEng->pFuncUpdate( pMaig, vTfo );
+  Vi_ForEachEntry( vTfo, iObj, i )
+    if ( i == 0 || !Tt_Equal(p->pSaved + nWords*i, Maig_ObjTruth(pMaig, iObj, 0), nWords) )
+      p->pChanged[iObj] = p->iBatch;
+}
+static inline void Rw_BatchRun( rw_batch * p )
+{
+  if ( p->p->pPool )
+    Rw_PoolRun( p->p->pPool, Rw_BatchJob, p );
+  else
+    Rw_BatchJob( p, 0, 1 );
+}
+// expands the nodes in batches; returns the number of added fanins
+static inline int Rw_BatchExpand( rw_batch * p, vi * vOrder, int nAddedMax, rw_prio * pPrio, int * pKeys, rw_rng * pRng )
+{
+  maig * pMaig = p->p; rw_rng * pRngMaig = pMaig->pRng;
+  int i, s, k, iLit, nAdded = 0, nAddedOne, nLimit;
+  for ( i = 0; i < Vi_Size(vOrder) && nAdded < nAddedMax; i += p->nSpecs ) {
+    p->nSpecs = MinInt( p->nSpecsAlloc, Vi_Size(vOrder) - i );
+    p->iBatch++;
+    for ( s = 0; s < p->nSpecs; s++ ) {
+      rw_spec * pSpec = p->pSpecs + s;
+      pSpec->iObj   = Vi_Read( vOrder, i + s );
+      pSpec->nLimit = Vi_Space( pMaig->pvFans + pSpec->iObj );
+      Rng_Start( &pSpec->Rng, Rng_Next(pRng) );
+    }
+    Rw_BatchRun( p );
+    for ( s = 0; s < p->nSpecs && nAdded < nAddedMax; s++ ) {
+      rw_spec * pSpec = p->pSpecs + s;
+      vi * vTfo = pSpec->vTfo;
+      nLimit = MinInt( Vi_Space(pMaig->pvFans + pSpec->iObj), nAddedMax - nAdded );
+      if ( !Rw_BatchValid(p, pSpec) ) {
+        pMaig->pRng = &pSpec->Rng;
+        Vi_Shrink( pSpec->vFound, 0 );
+        p->pEng->pFuncExpandFind( pMaig, pSpec->iObj, nLimit, pSpec->vFound );
+        vTfo = pMaig->vTfo;
+        p->nRedos++;
+      }
+      nAdded += nAddedOne = Rw_ExpandAdd( pMaig, pSpec->iObj, pSpec->vFound, MinInt(Vi_Size(pSpec->vFound), nLimit) );
+      if ( nAddedOne )
+        Rw_BatchUpdate( p, vTfo );
+      Vi_ForEachEntryStop( pSpec->vFound, iLit, k, nAddedOne )
+        p->pGrown[Lit2Var(iLit)] = p->iBatch;
+      if ( pKeys )
+        Rw_PrioUpdate( pPrio, pKeys[pSpec->iObj], nAddedOne );
+    }
+  }
+  pMaig->pRng = pRngMaig;
+  return nAdded;
+}
+// reduces the nodes in batches; returns the number of removed fanins
+static inline int Rw_BatchReduce( rw_batch * p, vi * vOrder )
+{
+  maig * pMaig = p->p; int i, s, nRemoved = 0;
+  p->fReduce = 1;
+  for ( i = 0; i < Vi_Size(vOrder); i += p->nSpecs ) {
+    p->nSpecs = MinInt( p->nSpecsAlloc, Vi_Size(vOrder) - i );
+    p->iBatch++;
+    for ( s = 0; s < p->nSpecs; s++ )
+      p->pSpecs[s].iObj = Vi_Read( vOrder, i + s );
+    Rw_BatchRun( p );
+    for ( s = 0; s < p->nSpecs; s++ ) {
+      rw_spec * pSpec = p->pSpecs + s;
+      vi * vTfo = pSpec->vTfo;
+      if ( !Rw_BatchValid(p, pSpec) ) {
+        pSpec->Status = p->pEng->pFuncReduceFind( pMaig, pSpec->iObj, 0, 0, pSpec->vFound );
+        vTfo = pMaig->vTfo;
+        p->nRedos++;
+      }
+      if ( pSpec->Status == RW_REDUCE_NONE )
+        continue;
+      nRemoved += Rw_ReduceApply( pMaig, pSpec->iObj, pSpec->Status, pSpec->vFound );
+      Rw_BatchUpdate( p, vTfo );
+    }
+  }
+  return nRemoved;
+}
+
+static inline maig * Rw_Expand( maig * p, rw_par * pPars, rw_prio * pPrio, rw_rng * pRng, rw_rng * pRngWeight )
+{
+  int i, iNode, nAdded = 0, nAddedOne, nFaninAddLimitAll = pPars->nExpands, * pKeys = NULL;
+  rw_engine * pEng = Rw_EngineSelect( p );
+  assert( nFaninAddLimitAll > 0 );
+  vi * vOrder = pPrio ? NULL : Rw_CreateOrder( p, pRng );
+  //printf( "Random order:  " ); Vi_Print( p->vOrder );
+  p->fBlocked  = (pPars->nLayout == 2);
+  p->nMemLimit = pPars->nMemLimit;
+  p->pCareOuts = pPars->pCareOuts;
+  p->pRng      = pRng;
+  p->pPool     = pPars->pPool;
+  pEng->pFuncInit(p);
+  Maig_InitializeRefs(p);
+  if ( pPrio )
+    vOrder = Rw_CreateOrderWeighted( p, pPrio, &pKeys, pRngWeight );
+  if ( p->pKinds ) { // the XOR/MUX nodes do not get new fanins
+    int k = 0;
+    Vi_ForEachEntry( vOrder, iNode, i )
+      if ( Maig_ObjIsAnd(p, iNode) )
+        Vi_Write( vOrder, k++, iNode );
+    Vi_Shrink( vOrder, k );
+  }
+  if ( pPars->nBatch > 1 && !p->nSlots ) {
+    rw_batch * pBat = Rw_BatchStart( p, pEng, pPars->nBatch );
+    nAdded = Rw_BatchExpand( pBat, vOrder, nFaninAddLimitAll, pPrio, pKeys, pRng );
+    Rw_BatchStop( pBat );
+  }
+  else {
+    Vi_ForEachEntry( vOrder, iNode, i ) {
+      nAdded += nAddedOne = pEng->pFuncExpand(p, iNode, MinInt(Vi_Space(p->pvFans+iNode), nFaninAddLimitAll-nAdded));
+      if ( pKeys )
+        Rw_PrioUpdate( pPrio, pKeys[iNode], nAddedOne );
+      if ( nAdded >= nFaninAddLimitAll )
+        break;
+    }
+  }
+  assert( nAdded <= nFaninAddLimitAll );
+  if ( pKeys )
+    free( pKeys );
+  Maig_VerifyRefs(p);    
+  return Maig_DupDfs(p);  
+}
+static inline maig * Rw_Reduce( maig * p, rw_par * pPars, rw_rng * pRng )
+{
+  int i, iNode;
+  rw_engine * pEng = Rw_EngineSelect( p );
+  vi * vOrder = Rw_CreateOrder( p, pRng );
+  //printf( "Random order:  " ); Vi_Print( p->vOrder );
+  p->fBlocked  = (pPars->nLayout == 2);
+  p->nMemLimit = pPars->nMemLimit;
+  p->pCareOuts = pPars->pCareOuts;
+  p->pRng      = pRng;
+  p->pPool     = pPars->pPool;
+  pEng->pFuncInit(p);
+  Maig_InitializeRefs(p);
+/*  
+  int Value = Rng_Bound(pRng, 16);
+  if ( Value == 0 )
+    Maig_ForEachNodeReverse( p, iNode )
+      Rw_ReduceOne( p, iNode, 0, 0 );
+  else if ( Value == 1 )
+    Maig_ForEachNodeReverse( p, iNode )
+      Rw_ReduceOne2( p, iNode, 0, 0 );      
+  else if ( Value == 2 )
+    Maig_ForEachNode( p, iNode )
+      Rw_ReduceOne( p, iNode, 0, 0 );
+  else if ( Value == 3 )
+    Maig_ForEachNode( p, iNode )
+      Rw_ReduceOne2( p, iNode, 0, 0 );      
+  else if ( Value == 4 )
+    Vi_ForEachEntry( vOrder, iNode, i )
+      Rw_ReduceOne( p, iNode, 0, 0 );
+  else 
+    Vi_ForEachEntry( vOrder, iNode, i )
+      Rw_ReduceOne2( p, iNode, 0, 0 );
+*/
+  // works best for final
+  if ( pPars->nBatch > 1 && !p->nSlots ) {
+    rw_batch * pBat = Rw_BatchStart( p, pEng, pPars->nBatch );
+    Rw_BatchReduce( pBat, vOrder );
+    Rw_BatchStop( pBat );
+  }
+  else {
+    Vi_ForEachEntry( vOrder, iNode, i )
+      pEng->pFuncReduce( p, iNode, 0, 0 );
+  }
+  Maig_VerifyRefs(p);
+  return Maig_DupStrash(p, 1, 1);
+}
+static inline maig * Rw_Resub( maig * p, rw_par * pPars )
+{
+  int iNode;
+  rw_engine * pEng = Rw_EngineSelect( p );
+  p->fBlocked  = (pPars->nLayout == 2);
+  p->nMemLimit = pPars->nMemLimit;
+  p->pCareOuts = pPars->pCareOuts;
+  p->pPool     = pPars->pPool;
+  pEng->pFuncInit(p);
+  Maig_InitializeRefs(p);
+  Maig_TruthSignStart(p);
+  Maig_ForEachNode( p, iNode )
+    if ( p->pRefs[iNode] > 0 )
+      pEng->pFuncResub( p, iNode, pPars->nResub );
+  Maig_VerifyRefs(p);
+  return Maig_DupDfs(p);
+}
+
+
+// storage for best AIGs
+#define SAVE_NUM 8
+
+// the random number streams of the run (each is split off the stream seeded by -S)
+#define RW_RNG_DECOMP  0     // the decomposition into multi-input nodes
+#define RW_RNG_ORDER   1     // the node order and the candidate fanins of expansion
+#define RW_RNG_BEST    2     // the selection among the best AIGs
+#define RW_RNG_CTRL    3     // the adaptive control
+#define RW_RNG_ACCEPT  4     // the acceptance of worse solutions
+#define RW_RNG_WEIGHT  5     // the keys of the weighted expansion order
+#define RW_RNG_REDUCE  6     // the node order and the candidate fanins of reduction
+#define RW_RNG_NUM     7
+
+static inline void Rw_StartStreams( rw_rng * pRngs, int nSeed )
+{
+  rw_rng Rng; int k;
+  Rng_Start( &Rng, nSeed );
+  for ( k = 0; k < RW_RNG_NUM; k++ )
+    Rng_Split( &Rng, pRngs + k );
+}
+
+// the best AIGs are stored packed (see Maig_Pack); the selected one is unpacked into the working AIG,
+// which is kept while the same entry is selected again; the supergates cached by the working AIG
+// are packed into its entry when another one is selected, so that each entry keeps its decomposition
+typedef struct rw_elites_ {
+  int             nBests;              // the number of stored AIGs
+  int             nAnd2;               // their size (all of them have the same number of AND2 gates)
+  unsigned char * pData[SAVE_NUM];     // the packed AIGs
+  int             nBytes[SAVE_NUM];    // their sizes in bytes
+  unsigned char * pSupers[SAVE_NUM];   // the packed supergates (NULL = not collected yet)
+  int             nSupers[SAVE_NUM];   // their sizes in bytes
+  int             fSupersDfs[SAVE_NUM];// the root order of the supergates
+  int             iWork;               // the entry unpacked into the working AIG (-1 = none)
+  maig *          pWork;               // the working AIG
+} rw_elites;
+
+static inline void Rw_FreeBest( rw_elites * p, int iNum )
+{
+  free( p->pData[iNum] );
+  free( p->pSupers[iNum] );
+  p->pData[iNum] = p->pSupers[iNum] = NULL;
+  if ( p->iWork == iNum )
+    p->iWork = -1;
+}
+static inline maig * Rw_StartBest( rw_elites * p, maig * pInit )
+{
+  memset( p, 0, sizeof(rw_elites) );
+  p->nBests   = 1;
+  p->nAnd2    = Maig_CountAnd2(pInit);
+  p->pData[0] = Maig_Pack( pInit, p->nBytes );
+  p->iWork    = 0;
+  return p->pWork = Maig_Unpack( p->pData[0], p->nBytes[0] );
+}
+static inline void Rw_AddBest( rw_elites * p, maig * pNew, rw_rng * pRng )
+{
+  int iNum = p->nBests;
+  if ( p->nBests < SAVE_NUM )
+    p->nBests++;
+  else
+    Rw_FreeBest( p, iNum = Rng_Bound(pRng, SAVE_NUM) );
+  p->nAnd2 = Maig_CountAnd2(pNew);
+  p->pData[iNum] = Maig_Pack( pNew, p->nBytes + iNum );
+}
+static inline maig * Rw_ReadBest( rw_elites * p, rw_rng * pRng )
+{
+  int iNum = Rng_Bound(pRng, p->nBests);
+  if ( p->iWork == iNum )
+    return p->pWork;
+  if ( p->iWork >= 0 && p->pWork->vSupers ) {
+    free( p->pSupers[p->iWork] );
+    p->pSupers[p->iWork]    = Maig_PackInts( p->pWork->vSupers, p->nSupers + p->iWork );
+    p->fSupersDfs[p->iWork] = p->pWork->fSupersDfs;
+  }
+  if ( p->pWork )
+    Maig_Free( p->pWork );
+  p->iWork = iNum;
+  p->pWork = Maig_Unpack( p->pData[iNum], p->nBytes[iNum] );
+  if ( p->pSupers[iNum] ) {
+    p->pWork->vSupers    = Maig_UnpackInts( p->pSupers[iNum], p->nSupers[iNum] );
+    p->pWork->fSupersDfs = p->fSupersDfs[iNum];
+  }
+  return p->pWork;
+}
+static inline void Rw_CleanBest( rw_elites * p )
+{
+  for ( int i = 0; i < p->nBests; i++ )
+    Rw_FreeBest( p, i );
+  p->nBests = 0;
+}
+static inline void Rw_StopBest( rw_elites * p )
+{
+  Rw_CleanBest( p );
+  if ( p->pWork )
+    Maig_Free( p->pWork );
+  p->pWork = NULL;
+}
+
+// The snapshot of the run is written to a temporary file renamed over the previous snapshot, 
+// every RW_SNAP_INTERVAL seconds and after the last iteration. It contains the iteration counter, 
+// the random number streams, the packed best networks with their cached supergates and the state 
+// of the acceptance, the adaptive control and the weighted order, so the resumed run is identical 
+// to the uninterrupted one (except for the timing-driven adaptive control). The snapshot is 
+// only used for the same input network and parameters (but the number of iterations can be raised).
+#define RW_SNAP_INTERVAL 60
+#define RW_SNAP_MAGIC    0x32504E5357455752ull // "RWEWSNP2"
+
+typedef struct rw_run_ {
+  word        Hash;         // the hash of the input network and the parameters
+  int         iIter;        // the next iteration
+  int         PrevBest;     // the best size reported
+  iword       Elapsed;      // the solving time before this iteration
+  iword *     pTimes;       // the solving time of the stages
+  rw_rng *    pRngs;        // the random number streams
+  rw_elites * pBests;       // the best networks
+  rw_adapt *  pAdapt;       // the adaptive control (or NULL)
+  rw_accept * pAccept;      // the acceptance (or NULL)
+  maig *      pCur;         // the current solution of the acceptance (or NULL)
+  rw_prio *   pPrio;        // the success scores of the weighted order (or NULL)
+} rw_run;
+
+typedef struct rw_reader_ {
+  unsigned char * pCur;     // the current position
+  unsigned char * pEnd;     // the end of the data
+  int             fError;   // the data ended prematurely or is inconsistent
+} rw_reader;
+
+static inline word Rw_SnapHash( maig * p, rw_par * pPars )
+{
+  int k, nBytes, pValues[15] = { pPars->nExpands, pPars->nGrowth, pPars->nDivs, pPars->nFaninMax, pPars->nSeed, pPars->nLayout, pPars->nBatch,
+                                 pPars->nRedecomp, pPars->nResub, pPars->fExact, pPars->fWeighted, pPars->fAdapt, pPars->nAccept, pPars->nAcceptPar, pPars->fXorMux };
+  unsigned char * pData = Maig_Pack( p, &nBytes );
+  word Res = Rw_HashMix( nBytes );
+  for ( k = 0; k < nBytes; k++ )
+    Res = Rw_HashMix( Res ^ pData[k] );
+  for ( k = 0; k < 15; k++ )
+    Res = Rw_HashMix( Res ^ (word)(unsigned)pValues[k] );
+  if ( pPars->pCareOuts )
+    for ( k = 0; k < p->nWords * p->nOuts; k++ )
+      Res = Rw_HashMix( Res ^ pPars->pCareOuts[k] );
+  free( pData );
+  return Res;
+}
+static inline void Rw_SnapWriteBytes( FILE * pFile, unsigned char * pData, int nBytes )
+{
+  fwrite( &nBytes, sizeof(int), 1, pFile );
+  if ( nBytes )
+    fwrite( pData, 1, nBytes, pFile );
+}
+static inline void Rw_SnapWriteSupers( FILE * pFile, maig * p )
+{
+  int nBytes = 0;
+  unsigned char * pData = (p && p->vSupers) ? Maig_PackInts( p->vSupers, &nBytes ) : NULL;
+  Rw_SnapWriteBytes( pFile, pData, nBytes );
+  fwrite( p ? &p->fSupersDfs : &nBytes, sizeof(int), 1, pFile );
+  if ( pData ) free( pData );
+}
+static inline void Rw_SnapSave( char * pFileName, rw_run * p )
+{
+  char FileTemp[1000]; word Magic = RW_SNAP_MAGIC;
+  rw_elites * pBests = p->pBests; int e, nBytes;
+  FILE * pFile;
+  snprintf( FileTemp, sizeof(FileTemp), "%s.tmp", pFileName );
+  if ( (pFile = fopen(FileTemp, "wb")) == NULL ) {
+    printf( "Cannot open the snapshot file \"%s\" for writing.\n", FileTemp );
+    return;
+  }
+  fwrite( &Magic,      sizeof(word),   1, pFile );
+  fwrite( &p->Hash,    sizeof(word),   1, pFile );
+  fwrite( &p->iIter,   sizeof(int),    1, pFile );
+  fwrite( &p->PrevBest,sizeof(int),    1, pFile );
+  fwrite( &p->Elapsed, sizeof(iword),  1, pFile );
+  fwrite( p->pTimes,   sizeof(iword),  5, pFile );
+  fwrite( p->pRngs,    sizeof(rw_rng), RW_RNG_NUM, pFile );
+  fwrite( &pBests->nBests, sizeof(int), 1, pFile );
+  fwrite( &pBests->nAnd2,  sizeof(int), 1, pFile );
+  fwrite( &pBests->iWork,  sizeof(int), 1, pFile );
+  for ( e = 0; e < pBests->nBests; e++ ) {
+    Rw_SnapWriteBytes( pFile, pBests->pData[e], pBests->nBytes[e] );
+    Rw_SnapWriteBytes( pFile, pBests->pSupers[e], pBests->pSupers[e] ? pBests->nSupers[e] : 0 );
+    fwrite( pBests->fSupersDfs + e, sizeof(int), 1, pFile );
+  }
+  Rw_SnapWriteSupers( pFile, pBests->iWork >= 0 ? pBests->pWork : NULL );
+  if ( p->pAdapt )
+    fwrite( p->pAdapt, sizeof(rw_adapt), 1, pFile );
+  if ( p->pAccept ) {
+    unsigned char * pData = Maig_Pack( p->pCur, &nBytes );
+    fwrite( &p->pAccept->nAccepted, sizeof(int), 1, pFile );
+    if ( p->pAccept->nHist )
+      fwrite( p->pAccept->pHist, sizeof(int), p->pAccept->nHist, pFile );
+    Rw_SnapWriteBytes( pFile, pData, nBytes );
+    Rw_SnapWriteSupers( pFile, p->pCur );
+    free( pData );
+  }
+  if ( p->pPrio )
+    fwrite( p->pPrio, sizeof(rw_prio), 1, pFile );
+  fwrite( &Magic, sizeof(word), 1, pFile );
+  if ( fclose( pFile ) ) {
+    printf( "Cannot write the snapshot file \"%s\".\n", FileTemp );
+    return;
+  }
+#ifdef _WIN32
+  remove( pFileName );
+#endif
+  if ( rename( FileTemp, pFileName ) )
+    printf( "Cannot rename the snapshot file \"%s\" into \"%s\".\n", FileTemp, pFileName );
+}
+static inline void Rw_SnapRead( rw_reader * p, void * pData, int nBytes )
+{
+  if ( p->fError || p->pEnd - p->pCur < nBytes ) {
+    p->fError = 1;
+    memset( pData, 0, nBytes );
+    return;
+  }
+  memcpy( pData, p->pCur, nBytes );
+  p->pCur += nBytes;
+}
+static inline unsigned char * Rw_SnapReadBytes( rw_reader * p, int * pnBytes )
+{
+  unsigned char * pData = NULL;
+  Rw_SnapRead( p, pnBytes, sizeof(int) );
+  if ( *pnBytes < 0 || p->pEnd - p->pCur < *pnBytes )
+    p->fError = 1;
+  if ( p->fError || *pnBytes == 0 )
+    return NULL;
+  pData = (unsigned char *)malloc( *pnBytes );
+  Rw_SnapRead( p, pData, *pnBytes );
+  return pData;
+}
+// restores the state of the run if the snapshot exists and matches the run; returns 1 on success
+static inline int Rw_SnapLoad( char * pFileName, rw_run * p )
+{
+  rw_elites Bests; rw_adapt Adapt; rw_reader Reader = { NULL, NULL, 0 }, * pReader = &Reader;
+  rw_rng Rngs[RW_RNG_NUM]; iword Elapsed, pTimes[5];
+  int e, iIter, PrevBest, nAccepted = 0, nWork = 0, fWorkDfs = 0, nCur = 0, nCurSupers = 0, fCurDfs = 0;
+  int * pHist = NULL; rw_prio * pPrio = NULL;
+  unsigned char * pData, * pWork = NULL, * pCur = NULL, * pCurSupers = NULL;
+  word Magic = 0, Hash = 0; size_t nSize;
+  FILE * pFile;
+  if ( (pFile = fopen(pFileName, "rb")) == NULL )
+    return 0;
+  fclose( pFile );
+  if ( (pData = Maig_FileMap( pFileName, &nSize )) == NULL )
+    return 0;
+  Reader.pCur = pData;
+  Reader.pEnd = pData + nSize;
+  Rw_SnapRead( pReader, &Magic, sizeof(word) );
+  Rw_SnapRead( pReader, &Hash,  sizeof(word) );
+  if ( Magic != RW_SNAP_MAGIC || Hash != p->Hash ) {
+    printf( "The snapshot \"%s\" was written for another network or other parameters and is ignored.\n", pFileName );
+    Maig_FileUnmap( pData, nSize );
+    return 0;
+  }
+  memset( &Bests, 0, sizeof(rw_elites) );
+  Rw_SnapRead( pReader, &iIter,    sizeof(int) );
+  Rw_SnapRead( pReader, &PrevBest, sizeof(int) );
+  Rw_SnapRead( pReader, &Elapsed,  sizeof(iword) );
+  Rw_SnapRead( pReader, pTimes,    sizeof(iword) * 5 );
+  Rw_SnapRead( pReader, Rngs,      sizeof(rw_rng) * RW_RNG_NUM );
+  Rw_SnapRead( pReader, &Bests.nBests, sizeof(int) );
+  Rw_SnapRead( pReader, &Bests.nAnd2,  sizeof(int) );
+  Rw_SnapRead( pReader, &Bests.iWork,  sizeof(int) );
+  if ( Bests.nBests < 1 || Bests.nBests > SAVE_NUM || Bests.iWork < -1 || Bests.iWork >= Bests.nBests )
+    Reader.fError = 1;
+  for ( e = 0; !Reader.fError && e < Bests.nBests; e++ ) {
+    Bests.pData[e]   = Rw_SnapReadBytes( pReader, Bests.nBytes + e );
+    Bests.pSupers[e] = Rw_SnapReadBytes( pReader, Bests.nSupers + e );
+    Rw_SnapRead( pReader, Bests.fSupersDfs + e, sizeof(int) );
+    if ( Bests.pData[e] == NULL )
+      Reader.fError = 1;
+  }
+  pWork = Rw_SnapReadBytes( pReader, &nWork );
+  Rw_SnapRead( pReader, &fWorkDfs, sizeof(int) );
+  if ( p->pAdapt )
+    Rw_SnapRead( pReader, &Adapt, sizeof(rw_adapt) );
+  if ( p->pAccept ) {
+    Rw_SnapRead( pReader, &nAccepted, sizeof(int) );
+    if ( p->pAccept->nHist ) {
+      pHist = (int *)malloc( sizeof(int) * p->pAccept->nHist );
+      Rw_SnapRead( pReader, pHist, sizeof(int) * p->pAccept->nHist );
+    }
+    pCur       = Rw_SnapReadBytes( pReader, &nCur );
+    pCurSupers = Rw_SnapReadBytes( pReader, &nCurSupers );
+    Rw_SnapRead( pReader, &fCurDfs, sizeof(int) );
+    if ( pCur == NULL )
+      Reader.fError = 1;
+  }
+  if ( p->pPrio ) {
+    pPrio = (rw_prio *)malloc( sizeof(rw_prio) );
+    Rw_SnapRead( pReader, pPrio, sizeof(rw_prio) );
+  }
+  Magic = 0;
+  Rw_SnapRead( pReader, &Magic, sizeof(word) );
+  if ( Magic != RW_SNAP_MAGIC || Reader.pCur != Reader.pEnd )
+    Reader.fError = 1;
+  Maig_FileUnmap( pData, nSize );
+  if ( Reader.fError ) {
+    printf( "The snapshot \"%s\" is incomplete and is ignored.\n", pFileName );
+    Bests.nBests = SAVE_NUM; // the unused entries are NULL
+    Bests.iWork  = -1;
+    Rw_StopBest( &Bests );
+    if ( pWork )      free( pWork );
+    if ( pHist )      free( pHist );
+    if ( pCur )       free( pCur );
+    if ( pCurSupers ) free( pCurSupers );
+    if ( pPrio )      free( pPrio );
+    return 0;
+  }
+  // replace the state of the run
+  p->iIter    = iIter;
+  p->PrevBest = PrevBest;
+  p->Elapsed  = Elapsed;
+  memcpy( p->pTimes, pTimes, sizeof(iword) * 5 );
+  memcpy( p->pRngs, Rngs, sizeof(rw_rng) * RW_RNG_NUM );
+  Rw_StopBest( p->pBests );
+  *p->pBests = Bests;
+  if ( Bests.iWork >= 0 ) {
+    p->pBests->pWork = Maig_Unpack( Bests.pData[Bests.iWork], Bests.nBytes[Bests.iWork] );
+    if ( pWork ) {
+      p->pBests->pWork->vSupers    = Maig_UnpackInts( pWork, nWork );
+      p->pBests->pWork->fSupersDfs = fWorkDfs;
+    }
+  }
+  if ( p->pAdapt )
+    *p->pAdapt = Adapt;
+  if ( p->pAccept ) {
+    p->pAccept->nAccepted = nAccepted;
+    if ( pHist )
+      memcpy( p->pAccept->pHist, pHist, sizeof(int) * p->pAccept->nHist );
+    Maig_Free( p->pCur );
+    p->pCur = Maig_Unpack( pCur, nCur );
+    if ( pCurSupers ) {
+      p->pCur->vSupers    = Maig_UnpackInts( pCurSupers, nCurSupers );
+      p->pCur->fSupersDfs = fCurDfs;
+    }
+  }
+  if ( p->pPrio )
+    memcpy( p->pPrio, pPrio, sizeof(rw_prio) );
+  if ( pWork )      free( pWork );
+  if ( pHist )      free( pHist );
+  if ( pCur )       free( pCur );
+  if ( pCurSupers ) free( pCurSupers );
+  if ( pPrio )      free( pPrio );
+  printf( "Resuming from the snapshot \"%s\" at iteration %d with %d AND nodes.\n", pFileName, iIter, Bests.nAnd2 );
+  return 1;
+}
+
+// the exact library is given by the caller or built for this run (if -N is used)
+static inline maig * Rw_PerformRewire( maig * p, rw_par * pPars, rw_exact * pExactIn )
+{
+  rw_elites Bests, * pBests = &Bests;
+  int i, k, n, iNode;
+  iword clkTotal = Time_Clock(); 
+  iword clk, times[5] = {0};
+  maig * pTemp, * pNew; 
+  maig * pBest = Rw_StartBest( pBests, p );
+  maig * pCur = NULL; // the current solution of the non-elitist strategies
+  int PrevBest = Maig_CountAnd2(pBest);
+  int nAnd2, nAdded, nShared, nResubed = 0, nRemoved, nExact = 0, nReplaced, nAndStart;
+  rw_par ParsIt = *pPars, * pParsIt = &ParsIt; // the parameters of the current iteration
+  rw_adapt Adapt, * pAdapt = pPars->fAdapt ? &Adapt : NULL;
+  rw_accept Accept, * pAccept = pPars->nAccept ? &Accept : NULL;
+  rw_prio * pPrio = pPars->fWeighted ? (rw_prio *)calloc( sizeof(rw_prio), 1 ) : NULL;
+  rw_exact * pExact = pExactIn ? pExactIn : pPars->fExact ? Rw_ExactStart( pPars->fVerbose ) : NULL;
+  rw_rng Rngs[RW_RNG_NUM];
+  rw_run Run, * pRun = &Run; // the state saved in the snapshots
+  iword clkIter, clkSnap = clkTotal;
+  int iStart = 0, fMemWarned = 0;
+  Rw_StartStreams( Rngs, pPars->nSeed );
+  if ( pAdapt )
+    Rw_AdaptStart( pAdapt, pPars );
+  if ( pAccept ) {
+    Rw_AcceptStart( pAccept, pPars, PrevBest );
+    pBest = pCur = Maig_Dup( p, 0 );
+  }
+  if ( pPars->pFileSnap ) {
+    memset( pRun, 0, sizeof(rw_run) );
+    pRun->Hash    = Rw_SnapHash( p, pPars );
+    pRun->pTimes  = times;
+    pRun->pRngs   = Rngs;
+    pRun->pBests  = pBests;
+    pRun->pAdapt  = pAdapt;
+    pRun->pAccept = pAccept;
+    pRun->pCur    = pCur;
+    pRun->pPrio   = pPrio;
+    if ( Rw_SnapLoad( pPars->pFileSnap, pRun ) ) {
+      iStart    = pRun->iIter;
+      PrevBest  = pRun->PrevBest;
+      clkTotal -= pRun->Elapsed;
+      pCur      = pRun->pCur;
+      pBest     = pAccept ? pCur : pBests->pWork;
+    }
+  }
+  for ( i = iStart; i < pPars->nIters; i++ )
+  {
+    clkIter   = Time_Clock();
+    nAndStart = Maig_CountAnd2(pBest);
+    if ( pAdapt )
+      Rw_AdaptSelect( pAdapt, pParsIt, Rngs + RW_RNG_CTRL );
+    // expand
+    clk      = Time_Clock(); 
+    pNew     = Maig_DupMulti(pBest, pParsIt->nFaninMax, pParsIt->nGrowth, pParsIt->nLayout > 0, pParsIt->fXorMux, pParsIt->nRedecomp, Rngs + RW_RNG_DECOMP);     
+    nAnd2    = Maig_CountAnd2(pNew);
+    pNew     = Rw_Expand(pTemp = pNew, pParsIt, pPrio, Rngs + RW_RNG_ORDER, Rngs + RW_RNG_WEIGHT); Maig_TruthSlotWarn( pTemp, &fMemWarned ); Maig_Free( pTemp );
+    nAdded   = Maig_CountAnd2(pNew) - nAnd2;
+    times[0]+= Time_Clock() - clk;
+    // share
+    clk      = Time_Clock(); 
+    nAnd2    = Maig_CountAnd2(pNew);  
+    pNew     = Rw_Share( pTemp = pNew, pParsIt->nDivs ); Maig_Free( pTemp );
+    nShared  = nAnd2 - Maig_CountAnd2(pNew);
+    times[1]+= Time_Clock() - clk;
+    // resubstitute
+    if ( pPars->nResub ) {
+      clk      = Time_Clock(); 
+      nAnd2    = Maig_CountAnd2(pNew);  
+      pNew     = Rw_Resub( pTemp = pNew, pParsIt );  Maig_TruthSlotWarn( pTemp, &fMemWarned ); Maig_Free( pTemp );
+      nResubed = nAnd2 - Maig_CountAnd2(pNew);
+      times[3]+= Time_Clock() - clk;
+    }
+    // reduce
+    clk      = Time_Clock(); 
+    nAnd2    = Maig_CountAnd2(pNew);  
+    pNew     = Rw_Reduce( pTemp = pNew, pParsIt, Rngs + RW_RNG_REDUCE );   Maig_TruthSlotWarn( pTemp, &fMemWarned ); Maig_Free( pTemp );
+    nRemoved = nAnd2 - Maig_CountAnd2(pNew);
+    times[2]+= Time_Clock() - clk;
+    // replace cuts
+    if ( pExact ) {
+      clk      = Time_Clock(); 
+      nAnd2    = Maig_CountAnd2(pNew);  
+      pNew     = Rw_Exact( pTemp = pNew, pExact, &nReplaced );   Maig_Free( pTemp );
+      nExact   = nAnd2 - Maig_CountAnd2(pNew);
+      times[4]+= Time_Clock() - clk;
+    }
+    if ( pAdapt )
+      Rw_AdaptUpdate( pAdapt, nAndStart - Maig_CountAnd2(pNew), Time_Clock() - clkIter );
+    // compare
+    if ( pAccept ) 
+    {
+      if ( pBests->nAnd2 > Maig_CountAnd2(pNew) ) {
+        Rw_CleanBest(pBests);
+        Rw_AddBest(pBests, pNew, NULL);
+      }
+      else if ( pBests->nAnd2 == Maig_CountAnd2(pNew) )
+        Rw_AddBest(pBests, pNew, Rngs + RW_RNG_BEST);
+      if ( Rw_AcceptCheck(pAccept, i, Maig_CountAnd2(pCur), Maig_CountAnd2(pNew), Rngs + RW_RNG_ACCEPT) )
+        RW_SWAP( maig *, pCur, pNew )
+      Maig_Free( pNew );
+      pBest = pCur;
+    }
+    else 
+    {
+      if ( Maig_CountAnd2(pBest) == Maig_CountAnd2(pNew) )
+        Rw_AddBest(pBests, pNew, Rngs + RW_RNG_BEST);
+      else if ( Maig_CountAnd2(pBest) > Maig_CountAnd2(pNew) ) {
+        Rw_CleanBest(pBests);
+        Rw_AddBest(pBests, pNew, NULL);
+      }
+      Maig_Free(pNew);
+      pBest = Rw_ReadBest(pBests, Rngs + RW_RNG_BEST);
+    }
+    // report
+    if ( PrevBest > pBests->nAnd2 && !pPars->fQuiet )
+    {
+        printf( "Iteration %5d :  ", i );
+        printf( "Added =%4d  ",     nAdded );
+        printf( "Shared =%4d  ",    nShared );
+        if ( pPars->nResub )
+        printf( "Resub =%4d  ",     nResubed );
+        printf( "Removed =%4d  ",   nRemoved );
+        if ( pExact )
+        printf( "Exact =%4d  ",     nExact );
+        printf( "Best =%5d",        pBests->nAnd2 );
+        if ( pAdapt )
+        printf( "  (E = %d  G = %d  D = %d  F = %d)", pParsIt->nExpands, pParsIt->nGrowth, pParsIt->nDivs, pParsIt->nFaninMax );
+        printf( "\n" );
+        PrevBest = pBests->nAnd2;
+    }    
+    // save the state
+    if ( pPars->pFileSnap && (i == pPars->nIters - 1 || Time_Clock() - clkSnap >= (iword)RW_SNAP_INTERVAL * CLOCKS_PER_SEC) ) {
+      pRun->iIter    = i + 1;
+      pRun->PrevBest = PrevBest;
+      pRun->Elapsed  = Time_Clock() - clkTotal;
+      pRun->pCur     = pCur;
+      Rw_SnapSave( pPars->pFileSnap, pRun );
+      clkSnap = Time_Clock();
+    }
+  }
+  if ( pAccept ) {
+    if ( pPars->fVerbose )
+      printf( "Accepted %d worse solutions in %d iterations.\n", pAccept->nAccepted, pPars->nIters );
+    Rw_AcceptStop( pAccept );
+    Maig_Free( pCur );
+  }
+  pBest = Maig_Unpack( pBests->pData[0], pBests->nBytes[0] );
+  Rw_StopBest( pBests );
+  if ( !pPars->fQuiet ) {
+    Time_Print( "Total solving time", Time_Clock() - clkTotal );
+    printf( "  (" );
+    printf( "Expand = %.1f %%  ", 100.0*times[0]/(Time_Clock() - clkTotal) );
+    printf( "Share = %.1f %%  ",  100.0*times[1]/(Time_Clock() - clkTotal) );
+    if ( pPars->nResub )
+    printf( "Resub = %.1f %%  ",  100.0*times[3]/(Time_Clock() - clkTotal) );
+    printf( "Reduce = %.1f %%",   100.0*times[2]/(Time_Clock() - clkTotal) );
+    if ( pExact )
+    printf( "  Exact = %.1f %%",  100.0*times[4]/(Time_Clock() - clkTotal) );
+    printf( ")\n" );
+  }
+  if ( pAdapt && pPars->fVerbose )
+    Rw_AdaptPrint( pAdapt );
+  if ( pPrio )
+    free( pPrio );
+  if ( pExact && pExact != pExactIn )
+    Rw_ExactStop( pExact );
+  return pBest;
+}
+
+// loads the external care sets from the companion outputs or from the care file
+// and returns the network without the companion outputs (or NULL if the care sets do not match)
+static inline maig * Rw_StartCare( maig * p, rw_par * pPars )
+{
+  maig * pCare, * pTemp; 
+  word * pTruths; int i, nOuts = p->nOuts, nWords = p->nWords;
+  if ( p->nRegs ) {
+    printf( "The care sets are not supported for the networks with registers.\n" );
+    return NULL;
+  }
+  if ( pPars->fCareOuts ) {
+    if ( p->nOuts % 2 ) {
+      printf( "The number of outputs (%d) is odd while the second half should be the care sets.\n", p->nOuts );
+      return NULL;
+    }
+    nOuts   = p->nOuts / 2;
+    pCare   = Maig_Dup( p, 0 );
+    pTruths = Maig_ComputeOutTruths( pCare );
+    pPars->pCareOuts = (word *)malloc( sizeof(word)*nWords*nOuts );
+    memcpy( pPars->pCareOuts, pTruths + nWords*nOuts, sizeof(word)*nWords*nOuts );
+    free( pTruths );
+    // drop the companion outputs
+    pCare->nObjs -= nOuts;
+    pCare->nOuts -= nOuts;
+    p = Maig_Dup( pTemp = pCare, 1 );
+    Maig_Free( pTemp );
+  }
+  else {
+    pCare = Maig_AigerRead( pPars->pFileCare, NULL, 0 );
+    if ( pCare == NULL )
+      return NULL;
+    if ( pCare->nIns != p->nIns || (pCare->nOuts != 1 && pCare->nOuts != p->nOuts) ) {
+      printf( "The care file has %d inputs and %d outputs while %d inputs and 1 or %d outputs are expected.\n", pCare->nIns, pCare->nOuts, p->nIns, p->nOuts );
+      Maig_Free( pCare );
+      return NULL;
+    }
+    pTruths = Maig_ComputeOutTruths( pCare );
+    pPars->pCareOuts = (word *)malloc( sizeof(word)*nWords*nOuts );
+    for ( i = 0; i < nOuts; i++ ) // one care set can be shared by all outputs
+      Tt_Dup( pPars->pCareOuts + nWords*i, pTruths + nWords*(pCare->nOuts == 1 ? 0 : i), nWords );
+    free( pTruths );
+    Maig_Free( pCare );
+    p = Maig_Dup( p, 0 );
+  }
+  printf( "Using external care sets of %d outputs (%.2f %% of minterms are don't-cares).\n", nOuts,
+    100.0 - 100.0 * Tt_CountOnesVec(pPars->pCareOuts, nWords*nOuts) / (64.0 * nWords * nOuts) );
+  return p;
+}
+
+/*************************************************************
+                   output partitioning
+**************************************************************/
+
+// The outputs are clustered greedily by the overlap of their supports: an output joins the part 
+// sharing the most inputs with it if the union of their supports does not exceed the limit (-J).
+// Each part is extracted with its own inputs (so its truth tables are sized by its support), 
+// the parts are optimized independently by the threads, and the results are merged by strashing.
+
+typedef struct rw_part_ {
+  vi *    vOuts;        // the outputs of the part
+  vi *    vSupp;        // the inputs in their support
+  maig *  pAig;         // the part extracted from the AIG
+  maig *  pNew;         // the optimized part
+} rw_part;
+
+typedef struct rw_parts_ {
+  rw_par *  pPars;      // the parameters of the run
+  rw_exact* pExact;     // the exact library shared by the parts (NULL = unused)
+  int       nParts;     // the number of parts
+  rw_part * pParts;     // the parts
+} rw_parts;
+
+static inline void Maig_CollectSupp_rec( maig * p, int iObj, vi * vSupp )
+{
+  int k, iLit;
+  if ( p->pTravIds[iObj] == p->nTravIds )
+    return;
+  p->pTravIds[iObj] = p->nTravIds;
+  if ( Maig_ObjIsPi(p, iObj) ) {
+    Vi_Push( vSupp, iObj );
+    return;
+  }
+  Maig_ForEachObjFanin( p, iObj, iLit, k )
+    Maig_CollectSupp_rec( p, Lit2Var(iLit), vSupp );
+}
+static int Rw_PartCompare( const void * p1, const void * p2 )
+{
+  word a = *(const word *)p1, b = *(const word *)p2;
+  return a < b ? -1 : a > b;
+}
+static int Rw_PartCompareInt( const void * p1, const void * p2 )
+{
+  return *(const int *)p1 - *(const int *)p2;
+}
+// clusters the outputs, which are visited in the order of decreasing support size
+static inline rw_part * Rw_PartCluster( maig * p, int nSuppMax, int * pnParts )
+{
+  rw_part * pParts = (rw_part *)calloc( sizeof(rw_part), p->nOuts );
+  vi ** pSupps  = (vi **)calloc( sizeof(vi *), p->nOuts );
+  word * pOrder = (word *)malloc( sizeof(word) * p->nOuts );
+  int * pMarks  = (int *)calloc( sizeof(int), p->nObjs );
+  int i, k, j, iIn, o, nParts = 0, nStamp = 0;
+  Maig_ForEachOutput( p, i ) {
+    o = i - (p->nObjs - p->nOuts);
+    pSupps[o] = Vi_Alloc( 16 );
+    p->nTravIds++;
+    Maig_CollectSupp_rec( p, Lit2Var(Maig_ObjFanin0(p, i)), pSupps[o] );
+    pOrder[o] = ((word)(p->nIns - Vi_Size(pSupps[o])) << 32) | (word)o;
+  }
+  qsort( pOrder, p->nOuts, sizeof(word), Rw_PartCompare );
+  for ( i = 0; i < p->nOuts; i++ ) {
+    vi * vSupp = pSupps[o = (int)(pOrder[i] & 0xFFFFFFFF)];
+    int iBest = -1, nBest = -1, nCommon;
+    nStamp++;
+    Vi_ForEachEntry( vSupp, iIn, k )
+      pMarks[iIn] = nStamp;
+    for ( j = 0; j < nParts; j++ ) {
+      nCommon = 0;
+      Vi_ForEachEntry( pParts[j].vSupp, iIn, k )
+        nCommon += pMarks[iIn] == nStamp;
+      if ( (nCommon > 0 || Vi_Size(vSupp) == 0) && nCommon > nBest && Vi_Size(pParts[j].vSupp) + Vi_Size(vSupp) - nCommon <= nSuppMax )
+        iBest = j, nBest = nCommon;
+    }
+    if ( iBest == -1 ) {
+      iBest = nParts++;
+      pParts[iBest].vOuts = Vi_Alloc( 16 );
+      pParts[iBest].vSupp = Vi_Alloc( Vi_Size(vSupp) );
+    }
+    nStamp++;
+    Vi_ForEachEntry( pParts[iBest].vSupp, iIn, k )
+      pMarks[iIn] = nStamp;
+    Vi_ForEachEntry( vSupp, iIn, k )
+      if ( pMarks[iIn] != nStamp )
+        Vi_Push( pParts[iBest].vSupp, iIn );
+    Vi_Push( pParts[iBest].vOuts, o );
+  }
+  // the inputs and outputs of each part keep their original order
+  for ( j = 0; j < nParts; j++ ) {
+    qsort( Vi_Array(pParts[j].vSupp), Vi_Size(pParts[j].vSupp), sizeof(int), Rw_PartCompareInt );
+    qsort( Vi_Array(pParts[j].vOuts), Vi_Size(pParts[j].vOuts), sizeof(int), Rw_PartCompareInt );
+  }
+  for ( o = 0; o < p->nOuts; o++ )
+    Vi_Free( pSupps[o] );
+  free( pSupps );
+  free( pOrder );
+  free( pMarks );
+  *pnParts = nParts;
+  return pParts;
+}
+// extracts the logic cones of the outputs of the part, whose inputs are the support of the part
+static inline maig * Maig_DupPart( maig * p, rw_part * pPart )
+{
+  int i, k, iLit, nNodes = 0;
+  p->nTravIds++;
+  Vi_ForEachEntry( pPart->vOuts, i, k )
+    Maig_MarkDfs_rec( p, Lit2Var(Maig_ObjFanin0(p, p->nObjs - p->nOuts + i)) );
+  Maig_ForEachNode( p, i )
+    nNodes += p->pTravIds[i] == p->nTravIds;
+  maig * pNew = Maig_Alloc( Vi_Size(pPart->vSupp), Vi_Size(pPart->vOuts), 1 + Vi_Size(pPart->vSupp) + nNodes + Vi_Size(pPart->vOuts) );
+  p->pCopy[0] = 0;
+  Vi_ForEachEntry( pPart->vSupp, i, k )
+    p->pCopy[i] = 1 + k;
+  Maig_ForEachNode( p, i ) {
+    if ( p->pTravIds[i] != p->nTravIds )
+      continue;
+    p->pCopy[i] = Maig_AppendObj(pNew);
+    Maig_ForEachObjFanin( p, i, iLit, k )
+      Maig_AppendFanin(pNew, p->pCopy[i], Lit2LitV(p->pCopy, iLit));
+  }
+  Vi_ForEachEntry( pPart->vOuts, i, k )
+    Maig_AppendFanin(pNew, Maig_AppendObj(pNew), Lit2LitV(p->pCopy, Maig_ObjFanin0(p, p->nObjs - p->nOuts + i)));
+  return pNew;
+}
+// puts the optimized parts together and shares their common logic
+static inline maig * Maig_DupParts( maig * p, rw_part * pParts, int nParts )
+{
+  int i, k, j, iLit, nObjsAlloc = 1 + p->nIns + p->nOuts;
+  int * pOutLits = (int *)calloc( sizeof(int), p->nOuts );
+  for ( j = 0; j < nParts; j++ )
+    nObjsAlloc += pParts[j].pNew->nObjs - 1 - pParts[j].pNew->nIns - pParts[j].pNew->nOuts;
+  maig * pTemp = Maig_Alloc( p->nIns, p->nOuts, nObjsAlloc ), * pNew;
+  pTemp->nRegs = p->nRegs;
+  for ( j = 0; j < nParts; j++ ) {
+    maig * q = pParts[j].pNew;
+    q->pCopy[0] = 0;
+    Vi_ForEachEntry( pParts[j].vSupp, i, k )
+      q->pCopy[1 + k] = i;
+    Maig_ForEachNode( q, i ) {
+      q->pCopy[i] = Maig_AppendObj(pTemp);
+      Maig_ForEachObjFanin( q, i, iLit, k )
+        Maig_AppendFanin(pTemp, q->pCopy[i], Lit2LitV(q->pCopy, iLit));
+    }
+    Vi_ForEachEntry( pParts[j].vOuts, i, k )
+      pOutLits[i] = Lit2LitV(q->pCopy, Maig_ObjFanin0(q, q->nObjs - q->nOuts + k));
+  }
+  for ( i = 0; i < p->nOuts; i++ )
+    Maig_AppendFanin(pTemp, Maig_AppendObj(pTemp), pOutLits[i]);
+  free( pOutLits );
+  pNew = Maig_DupStrash( pTemp, 1, 1 );
+  Maig_Free( pTemp );
+  return pNew;
+}
+static void Rw_PartJob( void * pArg, int iThread, int nThreads )
+{
+  rw_parts * p = (rw_parts *)pArg; int i;
+  rw_exact Exact, * pExact = p->pExact ? &Exact : NULL;
+  if ( pExact )
+    Rw_ExactShare( pExact, p->pExact );
+  for ( i = iThread; i < p->nParts; i += nThreads ) {
+    rw_par Pars = *p->pPars;
+    Pars.pPool    = NULL; // the threads are busy with the parts
+    Pars.pFileSnap = NULL;
+    Pars.fQuiet   = 1;
+    Pars.fVerbose = 0;
+    p->pParts[i].pNew = Rw_PerformRewire( p->pParts[i].pAig, &Pars, pExact );
+  }
+  if ( pExact )
+    free( pExact->pTrans );
+}
+static inline maig * Rw_PerformPartitioned( maig * p, rw_par * pPars )
+{
+  iword clkTotal = Time_Clock();
+  rw_parts Parts, * pMan = &Parts;
+  maig * pNew; int j;
+  pMan->pPars  = pPars;
+  pMan->pParts = Rw_PartCluster( p, pPars->nPartSupp, &pMan->nParts );
+  printf( "Partitioned %d outputs into %d parts with at most %d inputs (or one output).\n", p->nOuts, pMan->nParts, pPars->nPartSupp );
+  if ( pMan->nParts == 1 ) {
+    Vi_Free( pMan->pParts[0].vOuts );
+    Vi_Free( pMan->pParts[0].vSupp );
+    free( pMan->pParts );
+    return Rw_PerformRewire( p, pPars, NULL );
+  }
+  if ( pPars->pFileSnap )
+    printf( "The snapshot is not used with the output partitioning.\n" );
+  pMan->pExact = pPars->fExact ? Rw_ExactStart( pPars->fVerbose ) : NULL;
+  for ( j = 0; j < pMan->nParts; j++ )
+    pMan->pParts[j].pAig = Maig_DupPart( p, pMan->pParts + j );
+  if ( pPars->pPool )
+    Rw_PoolRun( pPars->pPool, Rw_PartJob, pMan );
+  else
+    Rw_PartJob( pMan, 0, 1 );
+  for ( j = 0; j < pMan->nParts; j++ ) {
+    rw_part * pPart = pMan->pParts + j;
+    if ( pPars->fVerbose )
+      printf( "Part %4d :  PI = %5d  PO = %5d  AND = %7d -> %7d\n", j, pPart->pAig->nIns, pPart->pAig->nOuts, Maig_CountAnd2(pPart->pAig), Maig_CountAnd2(pPart->pNew) );
+    Maig_Free( pPart->pAig );
+  }
+  pNew = Maig_DupParts( p, pMan->pParts, pMan->nParts );
+  if ( pMan->pExact )
+    Rw_ExactStop( pMan->pExact );
+  for ( j = 0; j < pMan->nParts; j++ ) {
+    Maig_Free( pMan->pParts[j].pNew );
+    Vi_Free( pMan->pParts[j].vOuts );
+    Vi_Free( pMan->pParts[j].vSupp );
+  }
+  free( pMan->pParts );
+  Time_Print( "Total solving time", Time_Clock() - clkTotal );
+  printf( "\n" );
+  return pNew;
+}
+
+/*************************************************************
+                     solution cache
+**************************************************************/
+
+// the best result for each network is kept in the cache directory as "<hash>.aig"
+// with the statistics in "<hash>.txt"; the hash is computed on the strashed network 
+// and does not depend on the node numbering or on the order of the fanins
+
+static inline word Rw_HashLit( word * pHash, int iLit )
+{
+  return Rw_HashMix( pHash[Lit2Var(iLit)] ^ (Lit2C(iLit) ? 0x9E3779B97F4A7C15ull : 0) );
+}
+static inline word Maig_StructHash( maig * p, word * pCareOuts )
+{
+  maig * pStr = Maig_DupStrash( p, 1, 1 );
+  word * pHash = (word *)calloc( sizeof(word), pStr->nObjs ), Res;
+  int i, k;
+  Maig_ForEachInput( pStr, i )
+    pHash[i] = Rw_HashMix( i );
+  Maig_ForEachNode( pStr, i ) {
+    word h0 = Rw_HashLit( pHash, Maig_ObjFanin0(pStr, i) );
+    word h1 = Rw_HashLit( pHash, Maig_ObjFanin1(pStr, i) );
+    pHash[i] = Rw_HashMix( Rw_HashMix(h0 < h1 ? h0 : h1) + (h0 < h1 ? h1 : h0) );
+  }
+  Res = Rw_HashMix( ((word)pStr->nIns << 32) | pStr->nOuts );
+  if ( pStr->nRegs ) // the same logic with registers is a different network
+    Res = Rw_HashMix( Res ^ pStr->nRegs );
+  Maig_ForEachOutput( pStr, i )
+    Res = Rw_HashMix( Res ^ Rw_HashLit(pHash, Maig_ObjFanin0(pStr, i)) );
+  if ( pCareOuts ) // the result depends on the care sets
+    for ( k = 0; k < pStr->nWords * pStr->nOuts; k++ )
+      Res = Rw_HashMix( Res ^ pCareOuts[k] );
+  free( pHash );
+  Maig_Free( pStr );
+  return Res;
+}
+static inline void Rw_CacheFileName( char * pBuffer, char * pDir, word Hash, char * pExt )
+{
+  sprintf( pBuffer, "%s/%016llx.%s", pDir, (unsigned long long)Hash, pExt );
+}
+// returns the cached network if it is equivalent to the given one on the care set
+static inline maig * Rw_CacheLoad( maig * p, rw_par * pPars, word Hash )
+{
+  char FileName[1000]; int i, fEqual = 1;
+  word * pTruths, * pTruths2;
+  maig * pCached;
+  FILE * pFile;
+  Rw_CacheFileName( FileName, pPars->pCacheDir, Hash, "aig" );
+  if ( (pFile = fopen(FileName, "rb")) == NULL )
+    return NULL;
+  fclose( pFile );
+  if ( (pCached = Maig_AigerRead(FileName, NULL, 0)) == NULL )
+    return NULL;
+  if ( pCached->nIns != p->nIns || pCached->nOuts != p->nOuts || pCached->nRegs != p->nRegs ) {
+    printf( "The cached network \"%s\" does not match the input and is ignored.\n", FileName );
+    Maig_Free( pCached );
+    return NULL;
+  }
+  pTruths  = Maig_ComputeOutTruths( p );
+  pTruths2 = Maig_ComputeOutTruths( pCached );
+  for ( i = 0; fEqual && i < p->nOuts; i++ )
+    fEqual = pPars->pCareOuts ? Tt_EqualOnCare( pPars->pCareOuts + p->nWords*i, pTruths + p->nWords*i, pTruths2 + p->nWords*i, p->nWords ) :
+                                Tt_Equal( pTruths + p->nWords*i, pTruths2 + p->nWords*i, p->nWords );
+  free( pTruths );
+  free( pTruths2 );
+  if ( !fEqual || Maig_CountAnd2(pCached) > Maig_CountAnd2(p) ) {
+    if ( !fEqual )
+      printf( "The cached network \"%s\" is not equivalent to the input and is ignored.\n", FileName );
+    Maig_Free( pCached );
+    return NULL;
+  }
+  printf( "Starting from the cached network \"%s\" with %d AND nodes.\n", FileName, Maig_CountAnd2(pCached) );
+  return pCached;
+}
+// records the result if it improves the cached one and updates the statistics
+// both files are written to temporary files of this process and renamed into place, 
+// so that a crash or a concurrent run never leaves a truncated or mismatched cache entry
+static inline int Rw_CacheRename( char * pFileTemp, char * pFileName )
+{
+#ifdef _WIN32
+  remove( pFileName );
+#endif
+  if ( rename( pFileTemp, pFileName ) == 0 )
+    return 1;
+  printf( "Cannot rename the cache file \"%s\" into \"%s\".\n", pFileTemp, pFileName );
+  remove( pFileTemp );
+  return 0;
+}
+static inline void Rw_CacheSave( maig * p, rw_par * pPars, word Hash, int nAndsInput )
+{
+  char FileName[1000], FileTemp[1100]; 
+  int nAnds = -1, nIters = 0, nRuns = 0;
+  FILE * pFile;
+#ifdef _WIN32
+  _mkdir( pPars->pCacheDir );
+#else
+  mkdir( pPars->pCacheDir, 0755 );
+#endif
+  Rw_CacheFileName( FileName, pPars->pCacheDir, Hash, "txt" );
+  if ( (pFile = fopen(FileName, "rb")) ) {
+    if ( fscanf( pFile, "AND = %d  Iters = %d  Runs = %d", &nAnds, &nIters, &nRuns ) != 3 )
+      nAnds = -1, nIters = nRuns = 0;
+    fclose( pFile );
+  }
+  if ( nAnds == -1 || Maig_CountAnd2(p) < nAnds ) {
+    Rw_CacheFileName( FileName, pPars->pCacheDir, Hash, "aig" );
+    snprintf( FileTemp, sizeof(FileTemp), "%s.%d.tmp", FileName, (int)getpid() );
+    if ( !Maig_AigerWrite( FileTemp, p, 0 ) ) {
+      remove( FileTemp );
+      return;
+    }
+    if ( !Rw_CacheRename( FileTemp, FileName ) )
+      return;
+    nAnds = Maig_CountAnd2(p);
+    printf( "Updated the cached network \"%s\" with %d AND nodes.\n", FileName, nAnds );
+  }
+  Rw_CacheFileName( FileName, pPars->pCacheDir, Hash, "txt" );
+  snprintf( FileTemp, sizeof(FileTemp), "%s.%d.tmp", FileName, (int)getpid() );
+  if ( (pFile = fopen(FileTemp, "wb")) == NULL ) {
+    printf( "Cannot open the cache file \"%s\" for writing.\n", FileTemp );
+    return;
+  }
+  fprintf( pFile, "AND = %d  Iters = %d  Runs = %d\n", nAnds, nIters + pPars->nIters, nRuns + 1 );
+  fprintf( pFile, "PI = %d  PO = %d  InputAND = %d\n", p->nIns, p->nOuts, nAndsInput );
+  if ( fclose( pFile ) ) {
+    printf( "Cannot write the cache file \"%s\".\n", FileTemp );
+    remove( FileTemp );
+    return;
+  }
+  Rw_CacheRename( FileTemp, FileName );
+}
+
+// returns the optimized network (or NULL if the external care sets cannot be used)
+maig * Rw_TransformMaig( maig * p, rw_par * pPars )
+{
+  maig * pCare = NULL, * pCached = NULL, * pNew;
+  word Hash = 0;
+  if ( pPars->fCareOuts || pPars->pFileCare ) {
+    if ( (pCare = Rw_StartCare( p, pPars )) == NULL )
+      return NULL;
+    p = pCare;
+  }
+  if ( pPars->pCacheDir ) {
+    Hash    = Maig_StructHash( p, pPars->pCareOuts );
+    pCached = Rw_CacheLoad( p, pPars, Hash );
+  }
+  if ( pPars->nThreads > 1 )
+    pPars->pPool = Rw_PoolStart( pPars->nThreads );
+  if ( pPars->nPartSupp && pPars->pCareOuts )
+    printf( "Output partitioning is not used with the external care sets.\n" );
+  if ( pPars->nPartSupp && !pPars->pCareOuts )
+    pNew = Rw_PerformPartitioned( pCached ? pCached : p, pPars );
+  else
+    pNew = Rw_PerformRewire( pCached ? pCached : p, pPars, NULL );
+  if ( pPars->pPool )
+    Rw_PoolStop( pPars->pPool ), pPars->pPool = NULL;
+  if ( pPars->pCacheDir )
+    Rw_CacheSave( pNew, pPars, Hash, Maig_CountAnd2(p) );
+  if ( pCached )
+    Maig_Free( pCached );
+  if ( pCare )
+    Maig_Free( pCare );
+  if ( pPars->pCareOuts )
+    free( pPars->pCareOuts ), pPars->pCareOuts = NULL;
+  return pNew;
+}
+
+Mini_Aig_t * Rw_Transform( Mini_Aig_t * pAig, rw_par * pPars )
+{
+  if ( 1 )
+  {
+    maig * p = Maig_FromMiniAig( pAig );
+    maig * pNew = Rw_TransformMaig( p, pPars );
+    Maig_Free( p );
+    if ( pNew == NULL )
+      return NULL;
+    pAig = Maig_ToMiniAig( pNew );
+    Maig_Free( pNew );
+  }
+  else
+  {
+    rw_rng Rngs[RW_RNG_NUM]; Rw_StartStreams( Rngs, pPars->nSeed );
+    maig * p = Maig_FromMiniAig( pAig );                  // Maig_Print( p );
+    maig * pNew1 = Maig_DupMulti(p, pPars->nFaninMax, pPars->nGrowth, pPars->nLayout > 0, pPars->fXorMux, pPars->nRedecomp, Rngs + RW_RNG_DECOMP);  // Maig_Print( pNew1 );
+    maig * pNew2 = Rw_Expand(pNew1, pPars, NULL, Rngs + RW_RNG_ORDER, Rngs + RW_RNG_WEIGHT);  // Maig_Print( pNew2 );
+    maig * pNew3 = Rw_Reduce(pNew2, pPars, Rngs + RW_RNG_REDUCE);                     // Maig_Print( pNew3 );
+    pAig = Maig_ToMiniAig( pNew3 );
+    Maig_Free( pNew2 );
+    Maig_Free( pNew1 );
+    Maig_Free( p );
+  }
+  return pAig;
+}
+
+/*************************************************************
+                     microbenchmarks
+**************************************************************/
+
+// Each measurement repeats the operation in growing batches until the time budget (-B, in ms) 
+// is spent and prints the line "name,size,ops,ns_per_op", where the size is the number of words 
+// of the truth tables, the number of entries of the array, or the number of nodes of the network.
+// The results of the operations are accumulated into a checksum printed at the end, so that
+// the compiler cannot drop them.
+
+#define RW_BENCH( Name, Size, Budget, Body )                                               \
+  do {                                                                                     \
+    iword clkB = Time_Clock(), nOpsB = 0, nBatchB = 1, rB;                                 \
+    while ( Time_Clock() - clkB < (Budget) ) {                                             \
+      for ( rB = 0; rB < nBatchB; rB++ ) { Body; }                                         \
+      nOpsB += nBatchB;                                                                    \
+      nBatchB = MinInt( 2 * nBatchB, 1 << 20 );                                            \
+    }                                                                                      \
+    printf( "%s,%d,%lld,%.2f\n", Name, (int)(Size), (long long)nOpsB,                      \
+      1e9 * (double)(Time_Clock() - clkB) / CLOCKS_PER_SEC / (double)(nOpsB ? nOpsB : 1) ); \
+    fflush( stdout );                                                                      \
+  } while ( 0 )
+
+#define RW_BENCH_WORDS  16384 // the largest truth table in words
+#define RW_BENCH_FANINS 32    // the largest array of fanins
+
+static inline void Rw_BenchTruths( iword Budget, rw_rng * pRng, word * pSink )
+{
+  word * pIn1 = (word *)malloc( sizeof(word) * RW_BENCH_WORDS ), * pIn2 = (word *)malloc( sizeof(word) * RW_BENCH_WORDS );
+  word * pOut = (word *)malloc( sizeof(word) * RW_BENCH_WORDS ), * pCare = (word *)malloc( sizeof(word) * RW_BENCH_WORDS );
+  word * pCopy = (word *)malloc( sizeof(word) * RW_BENCH_WORDS );
+  int w, nWords;
+  for ( w = 0; w < RW_BENCH_WORDS; w++ ) {
+    pIn1[w]  = Rng_Next( pRng );
+    pIn2[w]  = ~pIn1[w];           // disjoint with the first one, so that Tt_IntersectC visits all words
+    pCare[w] = Rng_Next( pRng );
+  }
+  Tt_Dup( pCopy, pIn1, RW_BENCH_WORDS ); // equal to the first one, so that Tt_EqualOnCare visits all words
+  for ( nWords = 1; nWords <= RW_BENCH_WORDS; nWords *= 4 ) {
+    RW_BENCH( "Tt_DupC",        nWords, Budget, Tt_DupC( pOut, pIn1, (int)rB & 1, nWords ); *pSink += pOut[nWords-1] );
+    RW_BENCH( "Tt_Sharp",       nWords, Budget, Tt_Sharp( pOut, pIn1, (int)rB & 1, nWords ); *pSink += pOut[nWords-1] );
+    RW_BENCH( "Tt_IntersectC",  nWords, Budget, *pSink += Tt_IntersectC( pIn1, pIn2, 0, nWords ) );
+    RW_BENCH( "Tt_EqualOnCare", nWords, Budget, *pSink += Tt_EqualOnCare( pCare, pIn1, pCopy, nWords ) );
+  }
+  free( pIn1 );
+  free( pIn2 );
+  free( pOut );
+  free( pCare );
+  free( pCopy );
+}
+static inline void Rw_BenchArrays( iword Budget, rw_rng * pRng, word * pSink )
+{
+  int pLits[RW_BENCH_FANINS], i, n;
+  vi * v = Vi_Alloc( RW_BENCH_FANINS );
+  for ( n = 2; n <= RW_BENCH_FANINS; n *= 2 ) {
+    for ( i = 0; i < n; i++ ) // the literals of n/2 variables, so that some of them repeat or are complementary
+      pLits[i] = 2 + (int)Rng_Bound( pRng, n );
+    RW_BENCH( "Vi_PushOrder", n, Budget, Vi_Shrink( v, 0 ); for ( i = 0; i < n; i++ ) Vi_PushOrder( v, pLits[i] ); *pSink += Vi_Read( v, 0 ) );
+    RW_BENCH( "Vi_Drop", n, Budget, Vi_Shrink( v, 0 ); Vi_PushArray( v, pLits, n ); while ( Vi_Size(v) ) *pSink += Vi_Drop( v, 0 ) );
+    RW_BENCH( "Maig_ReduceFanins", n, Budget, Vi_Shrink( v, 0 ); Vi_PushArray( v, pLits, n ); Maig_ReduceFanins( v ); *pSink += Vi_Size( v ) );
+  }
+  Vi_Free( v );
+}
+static inline void Rw_BenchNetwork( maig * p, rw_par * pPars, iword Budget, rw_rng * pRng, word * pSink )
+{
+  maig * pMulti = Maig_DupMulti( p, pPars->nFaninMax, pPars->nGrowth, 0, pPars->fXorMux, 100, pRng ), * pTemp;
+  int nNodes = pMulti->nObjs - pMulti->nIns - pMulti->nOuts - 1;
+  if ( nNodes == 0 ) {
+    Maig_Free( pMulti );
+    return;
+  }
+  RW_BENCH( "Maig_DupStrash", Maig_CountAnd2(p), Budget, pTemp = Maig_DupStrash( p, 1, 1 ); *pSink += pTemp->nObjs; Maig_Free( pTemp ) );
+  RW_BENCH( "Maig_ComputeTfo", nNodes, Budget, *pSink += Vi_Size( Maig_ComputeTfo(pMulti, 1 + pMulti->nIns + (int)Rng_Bound(pRng, nNodes)) ) );
+  RW_BENCH( "Rw_FindShared", nNodes, Budget, Maig_JournalStart( pMulti ); *pSink += Rw_FindShared( pMulti, pPars->nDivs ); Maig_JournalUndo( pMulti ) );
+  Maig_Free( pMulti );
+}
+// runs all microbenchmarks; the network ones use the input network and its multi-input version (-F/-G/-D)
+static inline void Rw_Bench( maig * p, rw_par * pPars )
+{
+  iword Budget = (iword)pPars->nBench * CLOCKS_PER_SEC / 1000;
+  word Sink = 0; rw_rng Rng;
+  Rng_Start( &Rng, pPars->nSeed );
+  printf( "name,size,ops,ns_per_op\n" );
+  Rw_BenchTruths( Budget, &Rng, &Sink );
+  Rw_BenchArrays( Budget, &Rng, &Sink );
+  Rw_BenchNetwork( p, pPars, Budget, &Rng, &Sink );
+  printf( "# checksum %016llx\n", (unsigned long long)Sink );
+}
+
+/*************************************************************
+                    main() procedure
+**************************************************************/
+
+void Rw_OutputFilename( char * pIn, char * pOut )
+{
   int i, k = 0;
   for ( i = 0; i < strlen(pIn); i++ ) {
     if ( pIn[i] == '.' )
@@ -1589,66 +5645,161 @@ void Rw_OutputFilename( char * pIn, char * pOut )
 }
 int main(int argc, char ** argv)
 {
-    int nIters = 1000, nExpands = 100, nGrowth = 3, nDivs = 4, nFaninMax = 4, nSeed = 1, nTimeOut = 0, fVerbose = 0;
+    rw_par Pars, * pPars = &Pars;
+    memset( pPars, 0, sizeof(rw_par) );
+    pPars->nIters    = 1000;
+    pPars->nExpands  = 100;
+    pPars->nGrowth   = 3;
+    pPars->nDivs     = 4;
+    pPars->nFaninMax = 4;
+    pPars->nSeed     = 1;
+    pPars->nTimeOut  = 0;
+    pPars->nLayout   = 0;
+    pPars->nMemLimit = 0;
+    pPars->nThreads  = 1;
+    pPars->nBatch    = 0;
+    pPars->nPartSupp = 0;
+    pPars->nRedecomp = 100;
+    pPars->nAccept   = 0;
+    pPars->nAcceptPar= 0;
+    pPars->nResub    = 0;
+    pPars->fExact    = 0;
+    pPars->fWeighted = 0;
+    pPars->fAdapt    = 0;
+    pPars->fXorMux   = 0;
+    pPars->fCareOuts = 0;
+    pPars->pFileCare = NULL;
+    pPars->fVerbose  = 0;
     if ( argc == 1 )
     {
-        printf( "usage:  %s [-IEGDFSTV <num>] <file.aig>\n", argv[0] );
+        printf( "usage:  %s [-IEGDFSTLMPQJOUNWAHZYBxV <num>] [-XKCR <file>] <file.aig>\n", argv[0] );
         printf( "                   this program performs AIG re-wiring\n" );
         printf( "\n" );     
-        printf( "      -I <num>  :  the number of iterations [default = %d]\n",                 nIters );          
-        printf( "      -E <num>  :  the number of nodes to expand [default = %d]\n",            nExpands );        
-        printf( "      -G <num>  :  the number of fanins that can be added [default = %d]\n",   nGrowth );            
-        printf( "      -D <num>  :  the number of shared divisors to extract [default = %d]\n", nDivs );            
-        printf( "      -F <num>  :  the limit on the fanin count at a node [default = %d]\n",   nFaninMax );            
-        printf( "      -S <num>  :  the random seed [default = %d]\n",                          nSeed );
+        printf( "      -I <num>  :  the number of iterations [default = %d]\n",                 pPars->nIters );          
+        printf( "      -E <num>  :  the number of nodes to expand [default = %d]\n",            pPars->nExpands );        
+        printf( "      -G <num>  :  the number of fanins that can be added [default = %d]\n",   pPars->nGrowth );            
+        printf( "      -D <num>  :  the number of shared divisors to extract [default = %d]\n", pPars->nDivs );            
+        printf( "      -F <num>  :  the limit on the fanin count at a node [default = %d]\n",   pPars->nFaninMax );            
+        printf( "      -S <num>  :  the random seed [default = %d]\n",                          pPars->nSeed );
         printf( "      -T <num>  :  the timeout in seconds [default = unused]\n" );  
-        printf( "      -V <num>  :  the verbosity level [default = %d]\n",                      fVerbose );                        
+        printf( "      -L <num>  :  the layout (0 = as is, 1 = DFS order, 2 = DFS order and blocked simulation) [default = %d]\n", pPars->nLayout );
+        printf( "      -M <num>  :  the memory limit for truth tables in MB (tight limits slow down the run) [default = unused]\n" );  
+        printf( "      -P <num>  :  the number of threads simulating large truth tables [default = %d]\n", pPars->nThreads );
+        printf( "      -Q <num>  :  the number of nodes expanded/reduced speculatively at a time by the threads (0 = one by one) [default = %d]\n", pPars->nBatch );
+        printf( "      -J <num>  :  the support size limit of the output partitions optimized separately (0 = no partitioning) [default = %d]\n", pPars->nPartSupp );
+        printf( "      -O <num>  :  the percentage of supergates re-decomposed in each iteration [default = %d]\n", pPars->nRedecomp );
+        printf( "      -U <num>  :  the resubstitution level (0 = none, 1 = one divisor, 2 = two divisors) [default = %d]\n", pPars->nResub );
+        printf( "      -N <num>  :  enables replacement of 4-input cuts using the exact synthesis library [default = %d]\n", pPars->fExact );
+        printf( "      -W <num>  :  enables expansion order weighted by the MFFC size and the earlier success [default = %d]\n", pPars->fWeighted );
+        printf( "      -A <num>  :  enables adaptive control of -E/-G/-D/-F during the run [default = %d]\n", pPars->fAdapt );
+        printf( "      -x <num>  :  enables XOR/MUX nodes in the multi-input network (half of them frozen in each iteration) [default = %d]\n", pPars->fXorMux );
+        printf( "      -H <num>  :  the acceptance (0 = elitist, 1 = annealing, 2 = late acceptance, 3 = threshold) [default = %d]\n", pPars->nAccept );
+        printf( "      -Z <num>  :  the initial temperature/threshold or the history length of -H [default = auto]\n" );
+        printf( "      -Y <num>  :  the second half of the outputs are the care sets of the first half [default = %d]\n", pPars->fCareOuts );
+        printf( "      -X <file> :  the AIGER file with the care sets (one output or one for each output) [default = unused]\n" );
+        printf( "      -K <dir>  :  the directory of the solution cache [default = unused]\n" );
+        printf( "      -R <file> :  the snapshot of the run written periodically and resumed from if it exists [default = unused]\n" );
+        printf( "      -C <file> :  checks the equivalence of the input with this AIGER file instead of optimizing [default = unused]\n" );
+        printf( "      -B <num>  :  runs the microbenchmarks for this many milliseconds each instead of optimizing [default = unused]\n" );
+        printf( "      -V <num>  :  the verbosity level [default = %d]\n",                      pPars->fVerbose );                        
         printf( "    <file.aig>  :  the input file name\n" );
         return 1;
     }
     else
     {
-        Mini_Aig_t * pAig = NULL, * pNew = NULL;
+        maig * p = NULL, * pNew = NULL;
         char * pFileName = argv[argc-1], pFileNameOut[1000]; 
         Rw_OutputFilename( pFileName, pFileNameOut );
         for ( int c = 1; c < argc-1; c++ ) {
                if ( argv[c][0] == '-' && argv[c][1] == 'I' )
-            nIters = atoi(argv[++c]);
+            pPars->nIters = atoi(argv[++c]);
           else if ( argv[c][0] == '-' && argv[c][1] == 'E' )
-            nExpands = atoi(argv[++c]);
+            pPars->nExpands = atoi(argv[++c]);
           else if ( argv[c][0] == '-' && argv[c][1] == 'G' )
-            nGrowth = atoi(argv[++c]);            
+            pPars->nGrowth = atoi(argv[++c]);            
           else if ( argv[c][0] == '-' && argv[c][1] == 'D' )
-            nDivs = atoi(argv[++c]);            
+            pPars->nDivs = atoi(argv[++c]);            
           else if ( argv[c][0] == '-' && argv[c][1] == 'F' )
-            nFaninMax = atoi(argv[++c]);            
+            pPars->nFaninMax = atoi(argv[++c]);            
           else if ( argv[c][0] == '-' && argv[c][1] == 'S' )
-            nSeed = atoi(argv[++c]);
+            pPars->nSeed = atoi(argv[++c]);
           else if ( argv[c][0] == '-' && argv[c][1] == 'T' )
-            nTimeOut = atoi(argv[++c]);
+            pPars->nTimeOut = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'L' )
+            pPars->nLayout = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'M' )
+            pPars->nMemLimit = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'P' )
+            pPars->nThreads = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'Q' )
+            pPars->nBatch = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'J' )
+            pPars->nPartSupp = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'O' )
+            pPars->nRedecomp = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'U' )
+            pPars->nResub = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'N' )
+            pPars->fExact = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'W' )
+            pPars->fWeighted = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'A' )
+            pPars->fAdapt = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'x' )
+            pPars->fXorMux = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'H' )
+            pPars->nAccept = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'Z' )
+            pPars->nAcceptPar = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'Y' )
+            pPars->fCareOuts = atoi(argv[++c]);
+          else if ( argv[c][0] == '-' && argv[c][1] == 'X' )
+            pPars->pFileCare = argv[++c];
+          else if ( argv[c][0] == '-' && argv[c][1] == 'K' )
+            pPars->pCacheDir = argv[++c];
+          else if ( argv[c][0] == '-' && argv[c][1] == 'R' )
+            pPars->pFileSnap = argv[++c];
+          else if ( argv[c][0] == '-' && argv[c][1] == 'C' )
+            pPars->pFileCec = argv[++c];
+          else if ( argv[c][0] == '-' && argv[c][1] == 'B' )
+            pPars->nBench = atoi(argv[++c]);
           else if ( argv[c][0] == '-' && argv[c][1] == 'V' )
-            fVerbose = atoi(argv[++c]);
+            pPars->fVerbose = atoi(argv[++c]);
           else {
             printf( "Unknown command-line option (%s).\n", argv[c] );
             return 1;
           }
         }
-        printf( "Parameters:  Iters = %d  Expand = %d  Growth = %d  Divs = %d  FaninMax = %d  Seed = %d  Timeout = %d  Verbose = %d\n", 
-          nIters, nExpands, nGrowth, nDivs, nFaninMax, nSeed, nTimeOut, fVerbose );          
-        Random_Num( nSeed );
-        pAig = Mini_AigerRead( pFileName, 1 );
-        if ( pAig == NULL )
+        if ( pPars->pFileCec ) { // the equivalence checking mode
+          maig * p2 = NULL; int Status = -1;
+          if ( (p = Maig_AigerRead( pFileName, NULL, 1 )) && (p2 = Maig_AigerRead( pPars->pFileCec, NULL, 1 )) )
+            Status = Rw_CecPerform( p, p2, pPars->nSeed, pPars->fVerbose );
+          if ( p )  Maig_Free( p );
+          if ( p2 ) Maig_Free( p2 );
+          return Status != 1;
+        }
+        if ( pPars->nBench > 0 ) { // the microbenchmark mode
+          if ( (p = Maig_AigerRead( pFileName, NULL, 0 )) == NULL )
+            return 1;
+          Rw_Bench( p, pPars );
+          Maig_Free( p );
+          return 0;
+        }
+        printf( "Parameters:  Iters = %d  Expand = %d  Growth = %d  Divs = %d  FaninMax = %d  Seed = %d  Timeout = %d  Layout = %d  MemLimit = %d  Threads = %d  Batch = %d  PartSupp = %d  Redecomp = %d  Resub = %d  Exact = %d  Weighted = %d  Adapt = %d  XorMux = %d  Accept = %d  CareOuts = %d  Verbose = %d\n", 
+          pPars->nIters, pPars->nExpands, pPars->nGrowth, pPars->nDivs, pPars->nFaninMax, pPars->nSeed, pPars->nTimeOut, pPars->nLayout, pPars->nMemLimit, pPars->nThreads, pPars->nBatch, pPars->nPartSupp, pPars->nRedecomp, pPars->nResub, pPars->fExact, pPars->fWeighted, pPars->fAdapt, pPars->fXorMux, pPars->nAccept, pPars->fCareOuts, pPars->fVerbose );          
+        p = Maig_AigerRead( pFileName, NULL, 1 );
+        if ( p == NULL )
           return 1;
-        Mini_AigPrintStats( pAig );
-        pNew = Rw_Transform( pAig, nIters, nExpands, nGrowth, nDivs, nFaninMax, nTimeOut, fVerbose );
+        Maig_PrintStats( p );
+        pNew = Rw_TransformMaig( p, pPars );
         if ( pNew == NULL )
           printf( "The output AIG is not produced.\n" );
         else {
-          Mini_AigPrintStats( pNew );
-          Mini_AigerWrite( pFileNameOut, pNew, 1 );
-          Mini_AigStop( pNew );
+          Maig_PrintStats( pNew );
+          Maig_AigerWrite( pFileNameOut, pNew, 1 );
+          Maig_Free( pNew );
         }
-        Mini_AigStop( pAig );
+        Maig_Free( p );
         return 1;
     }
 }